@@ -2,6 +2,7 @@
 #include "SetIterator.h"
 #include "ExtendedTest.h"
 #include "ShortTest.h"
+#include "Benchmark.h"
 #include <stack>
 #include <iostream>
 using namespace std;
@@ -13,6 +14,9 @@ int main() {
 
 	testAll();
 	testAllExtended();
+#ifdef RUN_BENCHMARKS
+	benchmarkAll();
+#endif
 
 	cout << "That's all!" << endl;
 	system("pause");
@@ -0,0 +1,418 @@
+#include "Benchmark.h"
+#include "Set.h"
+#include "SetIterator.h"
+#include "ConcurrentSet.h"
+#include "WordKernels.h"
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// the previous representation of Set, one bool for every element of [0, range)
+struct BoolArraySet {
+	bool* elements;
+	int capacity;
+
+	BoolArraySet(int range) : elements(new bool[range] {false}), capacity(range) {}
+	~BoolArraySet() { delete[] elements; }
+};
+
+static double elapsedMs(steady_clock::time_point start) {
+	return duration<double, milli>(steady_clock::now() - start).count();
+}
+
+void benchmarkBitmapLayout() {
+	cout << "Benchmark bitmap layout" << endl;
+	const int ranges[] = { 1000000, 100000000, 1000000000 };
+	const int step = 100; // one element out of step is present
+
+	for (int range : ranges) {
+		long long sumBool = 0;
+		double boolMs;
+		{
+			BoolArraySet b(range);
+			for (int i = 0; i < range; i += step) {
+				b.elements[i] = true;
+			}
+			b.elements[range - 1] = true;
+			auto start = steady_clock::now();
+			for (int i = 0; i < b.capacity; i++) {
+				if (b.elements[i])
+					sumBool += i;
+			}
+			boolMs = elapsedMs(start);
+		}
+
+		long long sumBits = 0;
+		double bitsMs;
+		{
+			Set s;
+			s.reserveRange(0, range - 1);
+			s.add(range - 1);
+			for (int i = 0; i < range; i += step) {
+				s.add(i);
+			}
+			auto start = steady_clock::now();
+			SetIterator it = s.iterator();
+			while (it.valid()) {
+				sumBits += it.getCurrent();
+				it.next();
+			}
+			bitsMs = elapsedMs(start);
+		}
+
+		long long boolBytes = range;
+		long long bitsBytes = ((long long)range + WORD_BITS - 1) / WORD_BITS * sizeof(TWord);
+		cout << "range " << range << ": bool[] " << boolBytes << " bytes, " << boolMs << " ms"
+			<< " | bitmap " << bitsBytes << " bytes, " << bitsMs << " ms"
+			<< (sumBool == sumBits ? "" : " (MISMATCH)") << endl;
+	}
+}
+
+void benchmarkSetAlgebra() {
+	cout << "Benchmark set algebra" << endl;
+	const int ranges[] = { 1000000, 100000000 };
+
+	for (int range : ranges) {
+		Set a;
+		Set b;
+		a.reserveRange(0, range - 1);
+		b.reserveRange(0, range - 1);
+		for (int i = 0; i < range; i += 2) {
+			a.add(i);
+		}
+		for (int i = 0; i < range; i += 3) {
+			b.add(i);
+		}
+		// both operands are read and the result is written once, isSubsetOf only reads
+		double gigabytes = 3.0 * range / 8 / 1e9;
+		double readGigabytes = 2.0 * range / 8 / 1e9;
+
+		Set perElement(a);
+		auto start = steady_clock::now();
+		SetIterator it = b.iterator();
+		while (it.valid()) {
+			perElement.add(it.getCurrent());
+			it.next();
+		}
+		double loopMs = elapsedMs(start);
+
+		Set bulk(a);
+		start = steady_clock::now();
+		bulk.unite(b);
+		double uniteMs = elapsedMs(start);
+
+		Set common(a);
+		start = steady_clock::now();
+		common.intersect(b);
+		double intersectMs = elapsedMs(start);
+
+		start = steady_clock::now();
+		bool subset = common.isSubsetOf(a);
+		double subsetMs = elapsedMs(start);
+
+		cout << "range " << range << ": per-element add " << gigabytes / (loopMs / 1000) << " GB/s"
+			<< " | unite " << gigabytes / (uniteMs / 1000) << " GB/s"
+			<< " | intersect " << gigabytes / (intersectMs / 1000) << " GB/s"
+			<< " | isSubsetOf " << readGigabytes / (subsetMs / 1000) << " GB/s"
+			<< (bulk.equals(perElement) && subset ? "" : " (MISMATCH)") << endl;
+	}
+}
+
+void benchmarkSparseScan() {
+	cout << "Benchmark sparse scan" << endl;
+	const int range = 100000000;
+	const int kept = 1000;
+
+	Set s;
+	s.reserveRange(0, range - 1);
+	for (int i = 0; i < range; i++) {
+		s.add(i);
+	}
+	for (int i = 0; i < range; i++) { //heavy removals leave a few scattered elements
+		if (i % (range / kept) != 0)
+			s.remove(i);
+	}
+
+	auto start = steady_clock::now();
+	long long sum = 0;
+	SetIterator it = s.iterator();
+	while (it.valid()) {
+		sum += it.getCurrent();
+		it.next();
+	}
+	double scanMs = elapsedMs(start);
+
+	start = steady_clock::now();
+	long long steps = 0;
+	for (int round = 0; round < 1000; round++) {
+		TElem e = s.successor(-1);
+		while (e != NULL_TELEM) {
+			e = s.successor(e);
+			steps++;
+		}
+	}
+	double successorNs = elapsedMs(start) * 1e6 / steps;
+
+	cout << "range " << range << ", " << s.size() << " elements: full scan " << scanMs << " ms"
+		<< " | successor " << successorNs << " ns per call" << (sum > 0 ? "" : " (MISMATCH)") << endl;
+}
+
+void benchmarkRanges() {
+	cout << "Benchmark ranges" << endl;
+	const int range = 100000000;
+
+	auto start = steady_clock::now();
+	Set perElement;
+	for (int i = 0; i < range; i++) {
+		perElement.add(i);
+	}
+	double addMs = elapsedMs(start);
+
+	start = steady_clock::now();
+	Set ranged;
+	ranged.addRange(0, range - 1);
+	double addRangeMs = elapsedMs(start);
+
+	start = steady_clock::now();
+	ranged.removeRange(range / 4, range / 4 * 3);
+	double removeRangeMs = elapsedMs(start);
+
+	TElem* batch = new TElem[range / 10];
+	for (int i = 0; i < range / 10; i++) {
+		batch[i] = (int)((i * 7919LL) % range);
+	}
+	start = steady_clock::now();
+	Set batched;
+	batched.addAll(batch, range / 10);
+	double addAllMs = elapsedMs(start);
+
+	start = steady_clock::now();
+	Set looped;
+	for (int i = 0; i < range / 10; i++) {
+		looped.add(batch[i]);
+	}
+	double loopMs = elapsedMs(start);
+	delete[] batch;
+
+	cout << range << " elements: add loop " << range / addMs / 1000 << " M/s"
+		<< " | addRange " << range / addRangeMs / 1000 << " M/s"
+		<< " | removeRange " << range / 2 / removeRangeMs / 1000 << " M/s" << endl;
+	cout << range / 10 << " scattered elements: add loop " << range / 10 / loopMs / 1000 << " M/s"
+		<< " | addAll " << range / 10 / addAllMs / 1000 << " M/s"
+		<< (batched.equals(looped) && perElement.size() == range ? "" : " (MISMATCH)") << endl;
+}
+
+void benchmarkSearchMany() {
+	cout << "Benchmark search many" << endl;
+	const int ranges[] = { 200000, 1000000000 }; // bitmap of 25 KB, inside the cache, and of 125 MB
+	const int n = 1 << 20;
+	const int rounds = 20;
+
+	TElem* keys = new TElem[n];
+	unsigned char* found = new unsigned char[n];
+	TWord* mask = new TWord[n / WORD_BITS];
+	for (int range : ranges) {
+		Set s;
+		s.reserveRange(0, range - 1);
+		for (int i = 0; i < range; i += 7) {
+			s.add(i);
+		}
+		unsigned long long seed = 88172645463325252ULL;
+		for (int i = 0; i < n; i++) { // about one key in ten is outside the set's range
+			seed ^= seed << 13;
+			seed ^= seed >> 7;
+			seed ^= seed << 17;
+			keys[i] = (TElem)(seed % (range + range / 10));
+		}
+
+		auto start = steady_clock::now();
+		long long hitsLoop = 0;
+		for (int round = 0; round < rounds; round++) {
+			for (int i = 0; i < n; i++) {
+				hitsLoop += s.search(keys[i]);
+			}
+		}
+		double loopMs = elapsedMs(start);
+
+		start = steady_clock::now();
+		long long hitsMany = 0;
+		for (int round = 0; round < rounds; round++) {
+			s.searchMany(keys, n, found);
+			for (int i = 0; i < n; i++) {
+				hitsMany += found[i];
+			}
+		}
+		double manyMs = elapsedMs(start);
+
+		start = steady_clock::now();
+		long long hitsMask = 0;
+		for (int round = 0; round < rounds; round++) {
+			s.searchManyMask(keys, n, mask);
+			hitsMask += countWords(mask, n / WORD_BITS);
+		}
+		double maskMs = elapsedMs(start);
+
+		double millions = (double)n * rounds / 1000;
+		cout << "range " << range << ": search loop " << millions / loopMs << " M keys/s"
+			<< " | searchMany " << millions / manyMs << " M keys/s"
+			<< " | searchManyMask " << millions / maskMs << " M keys/s"
+			<< (hitsLoop == hitsMany && hitsLoop == hitsMask ? "" : " (MISMATCH)") << endl;
+	}
+	delete[] keys;
+	delete[] found;
+	delete[] mask;
+}
+
+void benchmarkExport() {
+	cout << "Benchmark export" << endl;
+	const int members = 50000000;
+
+	Set s;
+	s.reserveRange(0, 2 * members - 1);
+	for (int i = 0; i < 2 * members; i++) { // a random-looking half of the values
+		if ((i * 2654435761u) >> 31)
+			s.add(i);
+	}
+	TElem* out = new TElem[s.size()];
+
+	auto start = steady_clock::now();
+	int countIterator = 0;
+	SetIterator it = s.iterator();
+	while (it.valid()) {
+		out[countIterator++] = it.getCurrent();
+		it.next();
+	}
+	double iteratorMs = elapsedMs(start);
+	long long sumIterator = 0;
+	for (int i = 0; i < countIterator; i++) {
+		sumIterator += out[i];
+	}
+
+	start = steady_clock::now();
+	int countArray = s.toArray(out);
+	double arrayMs = elapsedMs(start);
+	long long sumArray = 0;
+	for (int i = 0; i < countArray; i++) {
+		sumArray += out[i];
+	}
+
+	cout << s.size() << " elements: iterator " << iteratorMs << " ms | toArray " << arrayMs << " ms"
+		<< (sumIterator == sumArray && countIterator == countArray ? "" : " (MISMATCH)") << endl;
+	delete[] out;
+}
+
+void benchmarkRankSelect() {
+	cout << "Benchmark rank select" << endl;
+	const int range = 10000000;
+	const int queries = 1000;
+
+	Set s;
+	s.reserveRange(0, range - 1);
+	for (int i = 0; i < range; i += 3) {
+		s.add(i);
+	}
+
+	// rank and select by walking the iterator, the only option without the directory
+	auto start = steady_clock::now();
+	long long checksumWalk = 0;
+	for (int q = 0; q < queries; q++) {
+		TElem e = (TElem)((long long)q * 7919 % range);
+		int rank = 0;
+		SetIterator it = s.iterator();
+		while (it.valid() && it.getCurrent() < e) {
+			rank++;
+			it.next();
+		}
+		checksumWalk += rank;
+		it.first();
+		for (int k = 0; k < rank % 1000; k++) {
+			it.next();
+		}
+		checksumWalk += it.getCurrent();
+	}
+	double walkUs = elapsedMs(start) * 1000 / queries;
+
+	start = steady_clock::now();
+	s.rank(1); // builds the directory, the loop below measures the queries only
+	double buildMs = elapsedMs(start);
+
+	start = steady_clock::now();
+	const int fastQueries = queries * 1000;
+	long long checksumDirectory = 0;
+	for (int q = 0; q < fastQueries; q++) {
+		TElem e = (TElem)((long long)(q % queries) * 7919 % range);
+		int rank = s.rank(e);
+		checksumDirectory += rank + s.select(rank % 1000);
+	}
+	double directoryNs = elapsedMs(start) * 1e6 / fastQueries;
+
+	cout << s.size() << " elements: iterator walk " << walkUs << " us per rank+select"
+		<< " | directory build " << buildMs << " ms, " << directoryNs << " ns per rank+select"
+		<< (checksumWalk * 1000 == checksumDirectory ? "" : " (MISMATCH)") << endl;
+}
+
+void benchmarkConcurrentAdd() {
+	cout << "Benchmark concurrent add" << endl;
+	const int range = 100000000;
+	const int ids = 20000000; // total number of adds, split between the threads
+	int cores = (int)thread::hardware_concurrency();
+	if (cores < 4)
+		cores = 4;
+
+	// powers of 2, then the number of cores if it is not one of them
+	for (int threads = 1; threads <= cores; threads = (threads < cores && threads * 2 > cores) ? cores : threads * 2) {
+		// every thread walks the range with a different stride, so all of them touch all the words
+		vector<thread> workers;
+		ConcurrentSet concurrent(0, range - 1);
+		auto start = steady_clock::now();
+		for (int t = 0; t < threads; t++) {
+			workers.push_back(thread([&concurrent, t, threads, range, ids]() {
+				for (long long i = t; i < ids; i += threads) {
+					concurrent.add((TElem)(i * 2654435761LL % range));
+				}
+			}));
+		}
+		for (thread& w : workers) {
+			w.join();
+		}
+		double concurrentMs = elapsedMs(start);
+
+		workers.clear();
+		Set locked;
+		locked.reserveRange(0, range - 1);
+		mutex lock;
+		start = steady_clock::now();
+		for (int t = 0; t < threads; t++) {
+			workers.push_back(thread([&locked, &lock, t, threads, range, ids]() {
+				for (long long i = t; i < ids; i += threads) {
+					lock_guard<mutex> guard(lock);
+					locked.add((TElem)(i * 2654435761LL % range));
+				}
+			}));
+		}
+		for (thread& w : workers) {
+			w.join();
+		}
+		double lockedMs = elapsedMs(start);
+
+		cout << threads << " threads: lock-free " << ids / concurrentMs / 1000 << " M adds/s"
+			<< " | mutex " << ids / lockedMs / 1000 << " M adds/s"
+			<< (concurrent.size() == locked.size() ? "" : " (MISMATCH)") << endl;
+	}
+}
+
+void benchmarkAll() {
+	benchmarkBitmapLayout();
+	benchmarkSetAlgebra();
+	benchmarkSparseScan();
+	benchmarkRanges();
+	benchmarkSearchMany();
+	benchmarkExport();
+	benchmarkRankSelect();
+	benchmarkConcurrentAdd();
+}
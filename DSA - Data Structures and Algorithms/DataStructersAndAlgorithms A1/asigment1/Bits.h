@@ -0,0 +1,81 @@
+#pragma once
+
+#include <climits>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+typedef unsigned long long TWord;
+#define WORD_BITS 64
+#define ALL_ONES 0xFFFFFFFFFFFFFFFFULL
+
+// index of the lowest set bit of w (w must not be 0)
+inline int countTrailingZeros(TWord w) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, w);
+	return (int)index;
+#else
+	return __builtin_ctzll(w);
+#endif
+}
+//Complexity: BC=WC=AC=theta(1)
+
+
+// number of set bits of w
+inline int popCount(TWord w) {
+#ifdef _MSC_VER
+	return (int)__popcnt64(w);
+#else
+	return __builtin_popcountll(w);
+#endif
+}
+//Complexity: BC=WC=AC=theta(1)
+
+// index of the highest set bit of w (w must not be 0)
+inline int highestBit(TWord w) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse64(&index, w);
+	return (int)index;
+#else
+	return WORD_BITS - 1 - __builtin_clzll(w);
+#endif
+}
+//Complexity: BC=WC=AC=theta(1)
+
+
+// range of a table whose slots cover unit consecutive values each (unit is a power of 2), grown to contain [lo, hi]
+// base and capacity describe the current range, capacity 0 meaning no range yet, and receive the new one
+// geometric growth at least doubles the capacity and gives the extra slots to the side the range grows towards
+// no slot is ever reserved for values outside the range of int
+inline void growRange(long long& base, long long& capacity, long long lo, long long hi, long long unit, bool geometric) {
+	long long newBase = lo & ~(unit - 1);
+	long long last = hi;
+	if (capacity > 0) {
+		newBase = newBase < base ? newBase : base;
+		last = last > base + capacity * unit - 1 ? last : base + capacity * unit - 1;
+	}
+	long long needed = (last - newBase) / unit + 1;
+	long long newCapacity = needed;
+
+	if (geometric && capacity > 0) {
+		newCapacity = needed > 2 * capacity ? needed : 2 * capacity;
+		long long slack = newCapacity - needed;
+		bool growsDown = lo < base;
+		bool growsUp = hi >= base + capacity * unit;
+		if (growsDown && growsUp)
+			newBase -= slack / 2 * unit;
+		else if (growsDown)
+			newBase -= slack * unit;
+
+		newBase = newBase > (long long)INT_MIN ? newBase : (long long)INT_MIN;
+		long long fits = ((long long)INT_MAX - newBase) / unit + 1;
+		newCapacity = newCapacity < fits ? newCapacity : fits;
+	}
+
+	base = newBase;
+	capacity = newCapacity;
+}
+//Complexity: BC=WC=AC=theta(1)
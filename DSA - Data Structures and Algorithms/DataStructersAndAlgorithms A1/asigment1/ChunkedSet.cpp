@@ -0,0 +1,435 @@
+#include "ChunkedSet.h"
+#include "ChunkedSetIterator.h"
+#include <exception>
+using namespace std;
+
+// sizes in bytes of the three representations of a chunk
+static int arrayBytes(int cardinality) {
+    return cardinality * (int)sizeof(unsigned short);
+}
+
+static int runBytes(int runCount) {
+    return runCount * 2 * (int)sizeof(unsigned short);
+}
+
+static const int BITMAP_BYTES = CHUNK_WORDS * (int)sizeof(TWord);
+
+ChunkedSet::ChunkedSet() {
+    chunks = nullptr;
+    chunkCount = 0;
+    chunkCapacity = 0;
+    length = 0;
+}
+//Complexity: BC=WC=AC=theta(1)
+
+void ChunkedSet::split(TElem e, unsigned int& key, int& offset) {
+    // flipping the sign bit maps TElem onto unsigned values in the same order
+    unsigned int u = (unsigned int)e ^ 0x80000000u;
+    key = u >> CHUNK_BITS;
+    offset = (int)(u & (CHUNK_SIZE - 1));
+}
+//Complexity: BC=WC=AC=theta(1)
+
+TElem ChunkedSet::join(unsigned int key, int offset) {
+    return (TElem)(((key << CHUNK_BITS) | (unsigned int)offset) ^ 0x80000000u);
+}
+//Complexity: BC=WC=AC=theta(1)
+
+int ChunkedSet::lowerBound(unsigned int key) const {
+    int left = 0;
+    int right = chunkCount;
+    while (left < right) {
+        int middle = (left + right) / 2;
+        if (chunks[middle].key < key)
+            left = middle + 1;
+        else
+            right = middle;
+    }
+    return left;
+}
+//Complexity: BC=theta(1) WC=AC=theta(log chunkCount)
+
+// position of the first offset >= offset in a sorted array
+static int arrayLowerBound(const unsigned short* offsets, int count, int offset) {
+    int left = 0;
+    int right = count;
+    while (left < right) {
+        int middle = (left + right) / 2;
+        if (offsets[middle] < offset)
+            left = middle + 1;
+        else
+            right = middle;
+    }
+    return left;
+}
+//Complexity: BC=theta(1) WC=AC=theta(log count)
+
+int ChunkedSet::runFloor(const Run* runs, int count, int offset) {
+    int left = 0;
+    int right = count;
+    while (left < right) {
+        int middle = (left + right) / 2;
+        if (runs[middle].start <= offset)
+            left = middle + 1;
+        else
+            right = middle;
+    }
+    return left - 1;
+}
+//Complexity: BC=theta(1) WC=AC=theta(log count)
+
+bool ChunkedSet::chunkSearch(const Chunk& c, int offset) {
+    if (c.type == BITMAP_CHUNK)
+        return (c.bits[offset / WORD_BITS] >> (offset % WORD_BITS)) & 1;
+    if (c.type == ARRAY_CHUNK) {
+        int pos = arrayLowerBound(c.offsets, c.cardinality, offset);
+        return pos < c.cardinality && c.offsets[pos] == offset;
+    }
+    int pos = runFloor(c.runs, c.runCount, offset);
+    return pos >= 0 && offset <= c.runs[pos].last;
+}
+//Complexity: BC=theta(1) WC=AC=theta(log cardinality)
+
+bool ChunkedSet::chunkAdd(Chunk& c, int offset) {
+    if (chunkSearch(c, offset))
+        return false;
+
+    bool left = offset > 0 && chunkSearch(c, offset - 1);
+    bool right = offset < CHUNK_SIZE - 1 && chunkSearch(c, offset + 1);
+
+    if (c.type == BITMAP_CHUNK) {
+        c.bits[offset / WORD_BITS] |= 1ULL << (offset % WORD_BITS);
+    }
+    else if (c.type == ARRAY_CHUNK) {
+        if (c.cardinality == c.capacity) {
+            int newCapacity = c.capacity * 2;
+            unsigned short* newOffsets = new unsigned short[newCapacity];
+            for (int i = 0; i < c.cardinality; i++) {
+                newOffsets[i] = c.offsets[i];
+            }
+            delete[] c.offsets;
+            c.offsets = newOffsets;
+            c.capacity = newCapacity;
+        }
+        int pos = arrayLowerBound(c.offsets, c.cardinality, offset);
+        for (int i = c.cardinality; i > pos; i--) {
+            c.offsets[i] = c.offsets[i - 1];
+        }
+        c.offsets[pos] = (unsigned short)offset;
+    }
+    else {
+        int pos = runFloor(c.runs, c.runCount, offset);
+        if (left && right) {
+            // offset fills the gap between runs pos and pos + 1
+            c.runs[pos].last = c.runs[pos + 1].last;
+            for (int i = pos + 1; i < c.runCount - 1; i++) {
+                c.runs[i] = c.runs[i + 1];
+            }
+        }
+        else if (left) {
+            c.runs[pos].last++;
+        }
+        else if (right) {
+            c.runs[pos + 1].start--;
+        }
+        else {
+            if (c.runCount == c.capacity) {
+                int newCapacity = c.capacity * 2;
+                Run* newRuns = new Run[newCapacity];
+                for (int i = 0; i < c.runCount; i++) {
+                    newRuns[i] = c.runs[i];
+                }
+                delete[] c.runs;
+                c.runs = newRuns;
+                c.capacity = newCapacity;
+            }
+            for (int i = c.runCount; i > pos + 1; i--) {
+                c.runs[i] = c.runs[i - 1];
+            }
+            c.runs[pos + 1].start = (unsigned short)offset;
+            c.runs[pos + 1].last = (unsigned short)offset;
+        }
+    }
+
+    c.cardinality++;
+    c.runCount += 1 - (int)left - (int)right;
+    return true;
+}
+//Complexity: BC=theta(1) WC=AC=theta(cardinality)
+
+bool ChunkedSet::chunkRemove(Chunk& c, int offset) {
+    if (!chunkSearch(c, offset))
+        return false;
+
+    bool left = offset > 0 && chunkSearch(c, offset - 1);
+    bool right = offset < CHUNK_SIZE - 1 && chunkSearch(c, offset + 1);
+
+    if (c.type == BITMAP_CHUNK) {
+        c.bits[offset / WORD_BITS] &= ~(1ULL << (offset % WORD_BITS));
+    }
+    else if (c.type == ARRAY_CHUNK) {
+        int pos = arrayLowerBound(c.offsets, c.cardinality, offset);
+        for (int i = pos; i < c.cardinality - 1; i++) {
+            c.offsets[i] = c.offsets[i + 1];
+        }
+    }
+    else {
+        int pos = runFloor(c.runs, c.runCount, offset);
+        Run& run = c.runs[pos];
+        if (!left && !right) {
+            for (int i = pos; i < c.runCount - 1; i++) {
+                c.runs[i] = c.runs[i + 1];
+            }
+        }
+        else if (!left) {
+            run.start++;
+        }
+        else if (!right) {
+            run.last--;
+        }
+        else {
+            // offset splits the run in two
+            if (c.runCount == c.capacity) {
+                int newCapacity = c.capacity * 2;
+                Run* newRuns = new Run[newCapacity];
+                for (int i = 0; i < c.runCount; i++) {
+                    newRuns[i] = c.runs[i];
+                }
+                delete[] c.runs;
+                c.runs = newRuns;
+                c.capacity = newCapacity;
+            }
+            for (int i = c.runCount; i > pos + 1; i--) {
+                c.runs[i] = c.runs[i - 1];
+            }
+            c.runs[pos + 1].start = (unsigned short)(offset + 1);
+            c.runs[pos + 1].last = c.runs[pos].last;
+            c.runs[pos].last = (unsigned short)(offset - 1);
+        }
+    }
+
+    c.cardinality--;
+    c.runCount -= 1 - (int)left - (int)right;
+    return true;
+}
+//Complexity: BC=theta(1) WC=AC=theta(cardinality)
+
+int ChunkedSet::chunkNext(const Chunk& c, int from, int& pos) {
+    if (from >= CHUNK_SIZE)
+        return -1;
+    if (c.type == BITMAP_CHUNK) {
+        int k = from / WORD_BITS;
+        TWord word = c.bits[k] & (ALL_ONES << (from % WORD_BITS));
+        while (word == 0) {
+            if (++k == CHUNK_WORDS)
+                return -1;
+            word = c.bits[k];
+        }
+        return k * WORD_BITS + countTrailingZeros(word);
+    }
+    if (c.type == ARRAY_CHUNK) {
+        pos = arrayLowerBound(c.offsets, c.cardinality, from);
+        return pos < c.cardinality ? c.offsets[pos] : -1;
+    }
+    pos = runFloor(c.runs, c.runCount, from);
+    if (pos >= 0 && from <= c.runs[pos].last)
+        return from;
+    pos++;
+    return pos < c.runCount ? c.runs[pos].start : -1;
+}
+//Complexity: BC=theta(1) WC=AC=theta(CHUNK_WORDS)
+
+void ChunkedSet::chunkDecode(const Chunk& c, unsigned short* out) {
+    int n = 0;
+    if (c.type == BITMAP_CHUNK) {
+        for (int k = 0; k < CHUNK_WORDS; k++) {
+            TWord word = c.bits[k];
+            while (word != 0) {
+                out[n++] = (unsigned short)(k * WORD_BITS + countTrailingZeros(word));
+                word &= word - 1;
+            }
+        }
+    }
+    else if (c.type == ARRAY_CHUNK) {
+        for (int i = 0; i < c.cardinality; i++) {
+            out[i] = c.offsets[i];
+        }
+    }
+    else {
+        for (int i = 0; i < c.runCount; i++) {
+            for (int offset = c.runs[i].start; offset <= c.runs[i].last; offset++) {
+                out[n++] = (unsigned short)offset;
+            }
+        }
+    }
+}
+//Complexity: BC=WC=AC=theta(cardinality + CHUNK_WORDS)
+
+void ChunkedSet::chunkOptimize(Chunk& c) {
+    int current = c.type == BITMAP_CHUNK ? BITMAP_BYTES
+        : c.type == ARRAY_CHUNK ? arrayBytes(c.cardinality) : runBytes(c.runCount);
+    ChunkType best = ARRAY_CHUNK;
+    int bestBytes = arrayBytes(c.cardinality);
+    if (BITMAP_BYTES < bestBytes) {
+        best = BITMAP_CHUNK;
+        bestBytes = BITMAP_BYTES;
+    }
+    if (runBytes(c.runCount) < bestBytes) {
+        best = RUN_CHUNK;
+        bestBytes = runBytes(c.runCount);
+    }
+
+    // only switch when it saves at least a quarter of the memory,
+    // so a chunk sitting on a boundary does not convert back and forth on every update
+    if (best == c.type || bestBytes * 4 > current * 3)
+        return;
+
+    unsigned short* decoded = new unsigned short[c.cardinality];
+    chunkDecode(c, decoded);
+    chunkFree(c);
+
+    c.type = best;
+    if (best == BITMAP_CHUNK) {
+        c.bits = new TWord[CHUNK_WORDS]{ 0 };
+        for (int i = 0; i < c.cardinality; i++) {
+            c.bits[decoded[i] / WORD_BITS] |= 1ULL << (decoded[i] % WORD_BITS);
+        }
+        delete[] decoded;
+    }
+    else if (best == ARRAY_CHUNK) {
+        c.offsets = decoded;
+        c.capacity = c.cardinality;
+    }
+    else {
+        c.runs = new Run[c.runCount];
+        c.capacity = c.runCount;
+        int n = 0;
+        for (int i = 0; i < c.cardinality; i++) {
+            if (i > 0 && decoded[i] == decoded[i - 1] + 1) {
+                c.runs[n - 1].last = decoded[i];
+            }
+            else {
+                c.runs[n].start = decoded[i];
+                c.runs[n].last = decoded[i];
+                n++;
+            }
+        }
+        delete[] decoded;
+    }
+}
+//Complexity: BC=theta(1) WC=AC=theta(cardinality + CHUNK_WORDS)
+
+void ChunkedSet::chunkFree(Chunk& c) {
+    delete[] c.offsets;
+    delete[] c.bits;
+    delete[] c.runs;
+    c.offsets = nullptr;
+    c.bits = nullptr;
+    c.runs = nullptr;
+    c.capacity = 0;
+}
+//Complexity: BC=WC=AC=theta(1)
+
+bool ChunkedSet::add(TElem e) {
+    unsigned int key;
+    int offset;
+    split(e, key, offset);
+
+    int pos = lowerBound(key);
+    if (pos == chunkCount || chunks[pos].key != key) {
+        // new chunk, it starts as a one element array
+        if (chunkCount == chunkCapacity) {
+            int newCapacity = chunkCapacity == 0 ? 1 : chunkCapacity * 2;
+            Chunk* newChunks = new Chunk[newCapacity];
+            for (int i = 0; i < chunkCount; i++) {
+                newChunks[i] = chunks[i];
+            }
+            delete[] chunks;
+            chunks = newChunks;
+            chunkCapacity = newCapacity;
+        }
+        for (int i = chunkCount; i > pos; i--) {
+            chunks[i] = chunks[i - 1];
+        }
+        chunkCount++;
+
+        Chunk& c = chunks[pos];
+        c.key = key;
+        c.type = ARRAY_CHUNK;
+        c.cardinality = 1;
+        c.runCount = 1;
+        c.capacity = 4;
+        c.offsets = new unsigned short[4];
+        c.offsets[0] = (unsigned short)offset;
+        c.bits = nullptr;
+        c.runs = nullptr;
+        length++;
+        return true;
+    }
+
+    if (!chunkAdd(chunks[pos], offset))
+        return false;
+    chunkOptimize(chunks[pos]);
+    length++;
+    return true;
+}
+//Complexity: BC=theta(log chunkCount) WC=AC=theta(chunkCount + CHUNK_SIZE)
+
+bool ChunkedSet::remove(TElem elem) {
+    unsigned int key;
+    int offset;
+    split(elem, key, offset);
+
+    int pos = lowerBound(key);
+    if (pos == chunkCount || chunks[pos].key != key)
+        return false;
+    if (!chunkRemove(chunks[pos], offset))
+        return false;
+
+    length--;
+    if (chunks[pos].cardinality == 0) {
+        chunkFree(chunks[pos]);
+        for (int i = pos; i < chunkCount - 1; i++) {
+            chunks[i] = chunks[i + 1];
+        }
+        chunkCount--;
+    }
+    else {
+        chunkOptimize(chunks[pos]);
+    }
+    return true;
+}
+//Complexity: BC=theta(log chunkCount) WC=AC=theta(chunkCount + CHUNK_SIZE)
+
+bool ChunkedSet::search(TElem elem) const {
+    unsigned int key;
+    int offset;
+    split(elem, key, offset);
+
+    int pos = lowerBound(key);
+    return pos < chunkCount && chunks[pos].key == key && chunkSearch(chunks[pos], offset);
+}
+//Complexity: BC=theta(1) WC=AC=theta(log chunkCount + log CHUNK_SIZE)
+
+int ChunkedSet::size() const {
+    return length;
+}
+//Complexity: BC=WC=AC=theta(1)
+
+bool ChunkedSet::isEmpty() const {
+    return length == 0;
+}
+//Complexity: BC=WC=AC=theta(1)
+
+ChunkedSetIterator ChunkedSet::iterator() {
+    return ChunkedSetIterator(*this);
+}
+//Complexity: BC=WC=AC=theta(CHUNK_WORDS)
+
+ChunkedSet::~ChunkedSet() {
+    for (int i = 0; i < chunkCount; i++) {
+        chunkFree(chunks[i]);
+    }
+    delete[] chunks;
+}
+//Complexity: BC=WC=AC=theta(chunkCount)
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "Set.h"
+
+class ChunkedSetIterator;
+
+#define CHUNK_BITS 16
+#define CHUNK_SIZE 65536
+#define CHUNK_WORDS (CHUNK_SIZE / WORD_BITS)
+
+// Set for sparse elements spread over the whole range of TElem.
+// The range is split into chunks of CHUNK_SIZE consecutive values and only non-empty chunks are stored.
+// Every chunk keeps its elements in the smallest of three representations:
+// a sorted array of offsets, a bitmap of CHUNK_SIZE bits, or a sorted array of runs of consecutive values.
+class ChunkedSet {
+    friend class ChunkedSetIterator;
+
+private:
+    enum ChunkType { ARRAY_CHUNK, BITMAP_CHUNK, RUN_CHUNK };
+
+    struct Run {
+        unsigned short start; // first offset of the run
+        unsigned short last;  // last offset of the run (inclusive)
+    };
+
+    struct Chunk {
+        unsigned int key;         // high bits shared by all elements of the chunk
+        ChunkType type;           // representation currently used
+        int cardinality;          // number of elements in the chunk
+        int runCount;             // number of maximal runs of consecutive elements, kept for every representation
+        int capacity;             // slots allocated in offsets or runs
+        unsigned short* offsets;  // ARRAY_CHUNK: sorted offsets of the elements
+        TWord* bits;              // BITMAP_CHUNK: CHUNK_WORDS words
+        Run* runs;                // RUN_CHUNK: sorted runs, separated by at least one missing offset
+    };
+
+    //  Internal Representation
+    Chunk* chunks;     // dynamic array of the non-empty chunks, sorted by key
+    int chunkCount;    // number of chunks
+    int chunkCapacity; // size of the chunks array
+    int length;        // number of elements in the set
+
+    // splits e into its chunk key and its offset inside the chunk, keeping the order of TElem
+    static void split(TElem e, unsigned int& key, int& offset);
+    static TElem join(unsigned int key, int offset);
+
+    // position of the first chunk whose key is >= key
+    int lowerBound(unsigned int key) const;
+
+    // position of the last run starting at or before offset, -1 if there is none
+    static int runFloor(const Run* runs, int count, int offset);
+
+    static bool chunkSearch(const Chunk& c, int offset);
+    static bool chunkAdd(Chunk& c, int offset);
+    static bool chunkRemove(Chunk& c, int offset);
+
+    // smallest offset >= from in the chunk, or -1; pos receives its array or run position
+    static int chunkNext(const Chunk& c, int from, int& pos);
+
+    // writes the offsets of the chunk in increasing order to out
+    static void chunkDecode(const Chunk& c, unsigned short* out);
+
+    // switches the chunk to the smallest representation for its current contents
+    static void chunkOptimize(Chunk& c);
+    static void chunkFree(Chunk& c);
+
+public:
+    // implicit constructor
+    ChunkedSet();
+
+    ChunkedSet(const ChunkedSet&) = delete;
+    ChunkedSet& operator=(const ChunkedSet&) = delete;
+
+    // adds an element to the set
+    // returns true if the element was added, false otherwise
+    bool add(TElem e);
+
+    // removes an element from the set
+    // returns true if e was removed, false otherwise
+    bool remove(TElem e);
+
+    // checks whether an element belongs to the set or not
+    bool search(TElem elem) const;
+
+    // returns the number of elements
+    int size() const;
+
+    // check whether the set is empty or not
+    bool isEmpty() const;
+
+    // return an iterator for the set
+    ChunkedSetIterator iterator();
+
+    // destructor
+    ~ChunkedSet();
+};
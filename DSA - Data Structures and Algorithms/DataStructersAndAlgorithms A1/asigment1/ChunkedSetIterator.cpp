@@ -0,0 +1,84 @@
+#include "ChunkedSetIterator.h"
+#include "ChunkedSet.h"
+#include <exception>
+
+using namespace std;
+
+ChunkedSetIterator::ChunkedSetIterator(ChunkedSet& s) : set(s), chunk(0), offset(0), pos(0) {
+	first();
+}
+//Complexity: BC=WC=AC=theta(CHUNK_WORDS)
+
+void ChunkedSetIterator::settle(int c, int from) {
+    // chunks are never empty, so at most one chunk is searched without success
+    while (c < set.chunkCount) {
+        int found = ChunkedSet::chunkNext(set.chunks[c], from, pos);
+        if (found >= 0) {
+            chunk = c;
+            offset = found;
+            return;
+        }
+        c++;
+        from = 0;
+    }
+    chunk = set.chunkCount;
+}
+//Complexity: BC=theta(1) WC=AC=theta(CHUNK_WORDS)
+
+void ChunkedSetIterator::first() {
+    settle(0, 0);
+}
+//Complexity: BC=WC=AC=theta(CHUNK_WORDS)
+
+void ChunkedSetIterator::next() {
+    if (!valid())
+        throw exception();
+
+    const ChunkedSet::Chunk& c = set.chunks[chunk];
+    if (c.type == ChunkedSet::ARRAY_CHUNK && pos + 1 < c.cardinality) {
+        offset = c.offsets[++pos];
+    }
+    else if (c.type == ChunkedSet::RUN_CHUNK && offset < c.runs[pos].last) {
+        offset++;
+    }
+    else if (c.type == ChunkedSet::RUN_CHUNK && pos + 1 < c.runCount) {
+        offset = c.runs[++pos].start;
+    }
+    else if (c.type == ChunkedSet::BITMAP_CHUNK) {
+        settle(chunk, offset + 1);
+    }
+    else {
+        settle(chunk + 1, 0);
+    }
+}
+//Complexity: BC=theta(1) WC=AC=theta(CHUNK_WORDS)
+
+TElem ChunkedSetIterator::getCurrent() {
+    if (!valid())
+        throw exception();
+    return ChunkedSet::join(set.chunks[chunk].key, offset);
+}
+//Complexity: BC=WC=AC=theta(1)
+
+bool ChunkedSetIterator::valid() const {
+    return chunk < set.chunkCount;
+}
+//Complexity: BC=WC=AC=theta(1)
+
+TElem ChunkedSetIterator::remove() {
+    if (!valid())
+        throw exception();
+    TElem current = getCurrent();
+    unsigned int key = set.chunks[chunk].key;
+    int removedOffset = offset;
+    set.remove(current);
+
+    // the chunk may have changed representation or disappeared, so look the position up again
+    int c = set.lowerBound(key);
+    if (c < set.chunkCount && set.chunks[c].key == key)
+        settle(c, removedOffset + 1);
+    else
+        settle(c, 0);
+    return current;
+}
+//Complexity: BC=theta(log chunkCount) WC=AC=theta(chunkCount + CHUNK_SIZE)
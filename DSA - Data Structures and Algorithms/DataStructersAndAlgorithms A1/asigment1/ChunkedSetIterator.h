@@ -0,0 +1,25 @@
+#pragma once
+
+#include "ChunkedSet.h"
+
+class ChunkedSetIterator
+{
+	friend class ChunkedSet;
+
+private:
+	ChunkedSet& set; //reference to the container
+	ChunkedSetIterator(ChunkedSet& s); //private constructor of the iterator
+	int chunk; //position of the current chunk in set.chunks
+	int offset; //offset of the current element inside its chunk
+	int pos; //array or run position of the current element, unused for bitmap chunks
+
+	//moves to the first element with an offset >= from in chunk c, or to the first element of a later chunk
+	void settle(int c, int from);
+
+public:
+	void first();
+	void next();
+	TElem getCurrent();
+	bool valid() const;
+	TElem remove();
+};
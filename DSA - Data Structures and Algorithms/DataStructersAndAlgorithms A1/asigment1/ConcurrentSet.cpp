@@ -0,0 +1,103 @@
+#include "ConcurrentSet.h"
+#include <exception>
+using namespace std;
+
+ConcurrentSet::ConcurrentSet(TElem lo, TElem hi) {
+    if (lo > hi)
+        throw exception();
+    this->lo = lo;
+    this->hi = hi;
+    capacity = (int)(((long long)hi - lo) / WORD_BITS + 1);
+    words = new atomic<TWord>[capacity];
+    for (int k = 0; k < capacity; k++) {
+        words[k].store(0, memory_order_relaxed);
+    }
+    for (int i = 0; i < SIZE_STRIPES; i++) {
+        stripes[i].count.store(0, memory_order_relaxed);
+    }
+}
+//Complexity: BC=WC=AC=theta((hi - lo) / WORD_BITS)
+
+int ConcurrentSet::stripeOfThread() {
+    // threads take the stripes in turn the first time they change a set
+    static atomic<int> nextStripe(0);
+    thread_local int stripe = nextStripe.fetch_add(1, memory_order_relaxed) % SIZE_STRIPES;
+    return stripe;
+}
+//Complexity: BC=WC=AC=theta(1)
+
+bool ConcurrentSet::add(TElem e) {
+    if (e < lo || e > hi)
+        throw exception();
+
+    long long index = (long long)e - lo;
+    TWord mask = 1ULL << (index % WORD_BITS);
+    TWord old = words[index / WORD_BITS].fetch_or(mask, memory_order_acq_rel);
+    if (old & mask)
+        return false; // already in set
+
+    stripes[stripeOfThread()].count.fetch_add(1, memory_order_relaxed);
+    return true;
+}
+//Complexity: BC=WC=AC=theta(1)
+
+bool ConcurrentSet::remove(TElem elem) {
+    if (elem < lo || elem > hi)
+        return false;
+
+    long long index = (long long)elem - lo;
+    TWord mask = 1ULL << (index % WORD_BITS);
+    TWord old = words[index / WORD_BITS].fetch_and(~mask, memory_order_acq_rel);
+    if (!(old & mask))
+        return false;
+
+    stripes[stripeOfThread()].count.fetch_sub(1, memory_order_relaxed);
+    return true;
+}
+//Complexity: BC=WC=AC=theta(1)
+
+bool ConcurrentSet::search(TElem elem) const {
+    if (elem < lo || elem > hi)
+        return false;
+
+    long long index = (long long)elem - lo;
+    return (words[index / WORD_BITS].load(memory_order_acquire) >> (index % WORD_BITS)) & 1;
+}
+//Complexity: BC=WC=AC=theta(1)
+
+int ConcurrentSet::size() const {
+    // a stripe can go below zero when another thread removed what this one added
+    long long total = 0;
+    for (int i = 0; i < SIZE_STRIPES; i++) {
+        total += stripes[i].count.load(memory_order_relaxed);
+    }
+    return total < 0 ? 0 : (int)total;
+}
+//Complexity: BC=WC=AC=theta(SIZE_STRIPES)
+
+bool ConcurrentSet::isEmpty() const {
+    return size() == 0;
+}
+//Complexity: BC=WC=AC=theta(SIZE_STRIPES)
+
+Set ConcurrentSet::toSet() const {
+    Set result;
+    result.reserveRange(lo, hi);
+    TElem buffer[WORD_BITS];
+    for (int k = 0; k < capacity; k++) {
+        TWord word = words[k].load(memory_order_acquire);
+        int count = 0;
+        while (word != 0) {
+            buffer[count++] = (TElem)(lo + (long long)k * WORD_BITS + countTrailingZeros(word));
+            word &= word - 1;
+        }
+        result.addAll(buffer, count);
+    }
+    return result;
+}
+//Complexity: BC=WC=AC=theta((hi - lo) / WORD_BITS + size)
+
+ConcurrentSet::~ConcurrentSet() {
+    delete[] words;
+}
+//Complexity: BC=WC=AC=theta(1)
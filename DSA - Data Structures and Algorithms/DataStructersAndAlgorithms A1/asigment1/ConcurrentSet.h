@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Set.h"
+#include <atomic>
+
+// number of independent size counters, so that threads adding at the same time do not share one
+#define SIZE_STRIPES 16
+
+// Set over a range fixed at construction that many threads can change and query at the same time.
+// Every word of the bitmap is updated with a single atomic operation, so no lock is ever taken:
+// add and remove are lock-free and search is wait-free.
+class ConcurrentSet {
+private:
+    // one size counter, alone on its cache line
+    struct alignas(64) Stripe {
+        std::atomic<long long> count;
+    };
+
+    //  Internal Representation
+    std::atomic<TWord>* words; // bitmap, bit i stands for the element lo + i
+    TElem lo;                  // smallest element that can be stored
+    TElem hi;                  // largest element that can be stored
+    int capacity;              // number of words
+    Stripe stripes[SIZE_STRIPES];
+
+    // counter used by the calling thread
+    static int stripeOfThread();
+
+public:
+    // constructor for the elements of [lo, hi]
+    // throws an exception if lo > hi
+    ConcurrentSet(TElem lo, TElem hi);
+
+    ConcurrentSet(const ConcurrentSet&) = delete;
+    ConcurrentSet& operator=(const ConcurrentSet&) = delete;
+
+    // adds an element to the set
+    // returns true if the element was added, false otherwise
+    // throws an exception if e is outside [lo, hi]
+    bool add(TElem e);
+
+    // removes an element from the set
+    // returns true if e was removed, false otherwise
+    bool remove(TElem e);
+
+    // checks whether an element belongs to the set or not
+    bool search(TElem elem) const;
+
+    // returns the number of elements
+    // while other threads change the set the result may lag behind their latest changes
+    int size() const;
+
+    // check whether the set is empty or not
+    bool isEmpty() const;
+
+    // returns a Set with the elements of the set
+    // changes made by other threads during the copy may be missing from it
+    Set toSet() const;
+
+    // destructor
+    ~ConcurrentSet();
+};
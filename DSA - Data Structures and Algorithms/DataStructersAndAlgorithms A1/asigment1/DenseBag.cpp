@@ -0,0 +1,177 @@
+#include "DenseBag.h"
+#include "DenseBagIterator.h"
+#include <exception>
+#include <algorithm>
+#include <cstring>
+using namespace std;
+
+DenseBag::DenseBag() {
+    counts = nullptr;
+    base = 0;
+    capacity = 0;
+    minElem = 0;
+    maxElem = -1;
+    length = 0;
+    heavy = nullptr;
+    heavyCount = 0;
+    heavyCapacity = 0;
+}
+//Complexity: BC=WC=AC=theta(1)
+
+long long DenseBag::slotIndex(TElem e) const {
+    return (long long)e - base;
+}
+//Complexity: BC=WC=AC=theta(1)
+
+void DenseBag::grow(TElem lo, TElem hi) {
+    long long newBase = base;
+    long long newCapacity = capacity;
+    growRange(newBase, newCapacity, lo, hi, 1, true);
+
+    TCount* newCounts = new TCount[newCapacity]{ 0 };
+    if (capacity > 0)
+        memcpy(newCounts + (base - newBase), counts, capacity * sizeof(TCount));
+    delete[] counts;
+    counts = newCounts;
+    base = newBase;
+    capacity = newCapacity;
+}
+//Complexity: BC=WC=AC=theta(capacity)
+
+int DenseBag::heavyLowerBound(TElem e) const {
+    int left = 0;
+    int right = heavyCount;
+    while (left < right) {
+        int middle = (left + right) / 2;
+        if (heavy[middle].value < e)
+            left = middle + 1;
+        else
+            right = middle;
+    }
+    return left;
+}
+//Complexity: BC=theta(1) WC=AC=theta(log heavyCount)
+
+int DenseBag::occurrences(long long slot) const {
+    if (counts[slot] < COUNT_MAX)
+        return counts[slot];
+    TElem e = (TElem)(base + slot);
+    int pos = heavyLowerBound(e);
+    if (pos < heavyCount && heavy[pos].value == e)
+        return COUNT_MAX + heavy[pos].extra;
+    return COUNT_MAX;
+}
+//Complexity: BC=theta(1) WC=AC=theta(log heavyCount)
+
+long long DenseBag::nextSlot(long long from) const {
+    long long end = slotIndex(maxElem) + 1;
+    // runs of empty slots are skipped one word at a time
+    while (from + (long long)sizeof(TWord) <= end) {
+        TWord word;
+        memcpy(&word, counts + from, sizeof(TWord));
+        if (word != 0)
+            break;
+        from += sizeof(TWord) / sizeof(TCount);
+    }
+    while (from < end && counts[from] == 0) {
+        from++;
+    }
+    return from;
+}
+//Complexity: BC=theta(1) WC=AC=theta(maxElem - minElem)
+
+void DenseBag::add(TElem e) {
+    if (capacity == 0 || slotIndex(e) < 0 || slotIndex(e) >= capacity)
+        grow(e, e);
+    if (minElem > maxElem) {
+        // first element ever added
+        minElem = e;
+        maxElem = e;
+    }
+    minElem = min(minElem, e);
+    maxElem = max(maxElem, e);
+
+    TCount& c = counts[slotIndex(e)];
+    length++;
+    if (c < COUNT_MAX) {
+        c++;
+        return;
+    }
+
+    // saturated counter: the rest goes to the side table
+    int pos = heavyLowerBound(e);
+    if (pos < heavyCount && heavy[pos].value == e) {
+        heavy[pos].extra++;
+        return;
+    }
+    if (heavyCount == heavyCapacity) {
+        heavyCapacity = max(4, 2 * heavyCapacity);
+        Heavy* newHeavy = new Heavy[heavyCapacity];
+        copy(heavy, heavy + heavyCount, newHeavy);
+        delete[] heavy;
+        heavy = newHeavy;
+    }
+    copy_backward(heavy + pos, heavy + heavyCount, heavy + heavyCount + 1);
+    heavy[pos].value = e;
+    heavy[pos].extra = 1;
+    heavyCount++;
+}
+//Complexity: BC=theta(1) WC=theta(capacity + heavyCount) AC=theta(1) amortized for keys below COUNT_MAX
+
+bool DenseBag::remove(TElem e) {
+    if (e < minElem || e > maxElem)
+        return false;
+    TCount& c = counts[slotIndex(e)];
+    if (c == 0)
+        return false;
+
+    length--;
+    if (c == COUNT_MAX) {
+        int pos = heavyLowerBound(e);
+        if (pos < heavyCount && heavy[pos].value == e) {
+            if (--heavy[pos].extra == 0) {
+                copy(heavy + pos + 1, heavy + heavyCount, heavy + pos);
+                heavyCount--;
+            }
+            return true;
+        }
+    }
+    c--;
+    return true;
+}
+//Complexity: BC=theta(1) WC=theta(heavyCount) AC=theta(1) for keys below COUNT_MAX
+
+bool DenseBag::search(TElem e) const {
+    if (e < minElem || e > maxElem)
+        return false;
+    return counts[slotIndex(e)] != 0;
+}
+//Complexity: BC=WC=AC=theta(1)
+
+int DenseBag::nrOccurrences(TElem e) const {
+    if (e < minElem || e > maxElem)
+        return 0;
+    return occurrences(slotIndex(e));
+}
+//Complexity: BC=theta(1) WC=theta(log heavyCount) AC=theta(1) for keys below COUNT_MAX
+
+int DenseBag::size() const {
+    return length;
+}
+//Complexity: BC=WC=AC=theta(1)
+
+bool DenseBag::isEmpty() const {
+    return length == 0;
+}
+//Complexity: BC=WC=AC=theta(1)
+
+DenseBagIterator DenseBag::iterator() const {
+    return DenseBagIterator(*this);
+}
+//Complexity: BC=theta(1) WC=AC=theta(maxElem - minElem)
+
+DenseBag::~DenseBag() {
+    delete[] counts;
+    delete[] heavy;
+}
+//Complexity: BC=WC=AC=theta(1)
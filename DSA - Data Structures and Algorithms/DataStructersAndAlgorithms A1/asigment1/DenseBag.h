@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Set.h"
+
+class DenseBagIterator;
+
+// counter stored for every slot, change both lines for 16-bit counters
+typedef unsigned char TCount;
+#define COUNT_MAX 255
+
+// Bag of integers for dense keys, laid out like Set: slot e - base holds the number of occurrences of e.
+// Counters saturate at COUNT_MAX; the occurrences above it are kept in a small sorted side table,
+// which only the heavy keys ever touch.
+class DenseBag {
+    friend class DenseBagIterator;
+
+private:
+    struct Heavy {
+        TElem value; // element whose counter is saturated
+        int extra;   // occurrences above COUNT_MAX, always > 0
+    };
+
+    //  Internal Representation
+    TCount* counts;     // counts[i] = occurrences of base + i, up to COUNT_MAX
+    long long base;     // element stored in slot 0
+    long long capacity; // number of slots
+    TElem minElem;      // smallest element added so far, the bag may no longer contain it
+    TElem maxElem;      // largest element added so far, the bag may no longer contain it
+    int length;         // number of elements, with repetitions
+    Heavy* heavy;       // side table, sorted by value
+    int heavyCount;     // number of entries of the side table
+    int heavyCapacity;  // size of the side table
+
+    long long slotIndex(TElem e) const;
+
+    // makes counts cover [lo, hi], doubling the number of slots when it has to grow
+    void grow(TElem lo, TElem hi);
+
+    // position of the first entry of the side table whose value is >= e
+    int heavyLowerBound(TElem e) const;
+
+    // occurrences of the element of a non-empty slot
+    int occurrences(long long slot) const;
+
+    // first slot >= from with a non-zero counter, or one past the slot of maxElem if there is none
+    long long nextSlot(long long from) const;
+
+public:
+    // implicit constructor
+    DenseBag();
+
+    DenseBag(const DenseBag&) = delete;
+    DenseBag& operator=(const DenseBag&) = delete;
+
+    // adds an occurrence of e to the bag
+    void add(TElem e);
+
+    // removes one occurrence of e from the bag
+    // returns true if an occurrence was removed, false otherwise (if e was not part of the bag)
+    bool remove(TElem e);
+
+    // checks if an element appears in the bag
+    bool search(TElem e) const;
+
+    // returns the number of occurrences of e in the bag
+    int nrOccurrences(TElem e) const;
+
+    // returns the number of elements of the bag, with repetitions
+    int size() const;
+
+    // checks if the bag is empty
+    bool isEmpty() const;
+
+    // returns an iterator over the elements in increasing order, every element repeated as many times as it occurs
+    DenseBagIterator iterator() const;
+
+    // destructor
+    ~DenseBag();
+};
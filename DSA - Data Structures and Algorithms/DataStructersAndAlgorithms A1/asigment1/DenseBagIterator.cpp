@@ -0,0 +1,45 @@
+#include "DenseBagIterator.h"
+#include "DenseBag.h"
+#include <exception>
+
+using namespace std;
+
+DenseBagIterator::DenseBagIterator(const DenseBag& b) : bag(b), slot(0), occurrence(0) {
+	first();
+}
+//Complexity: BC=theta(1) WC=AC=theta(maxElem - minElem)
+
+TElem DenseBagIterator::getCurrent() {
+	if (!valid())
+		throw exception();
+	return (TElem)(bag.base + slot);
+}
+//Complexity: BC=WC=AC=theta(1)
+
+bool DenseBagIterator::valid() {
+	return bag.minElem <= bag.maxElem && slot <= bag.slotIndex(bag.maxElem);
+}
+//Complexity: BC=WC=AC=theta(1)
+
+void DenseBagIterator::next() {
+	if (!valid())
+		throw exception();
+
+	occurrence++;
+	if (occurrence < bag.occurrences(slot))
+		return;
+	occurrence = 0;
+	slot = bag.nextSlot(slot + 1);
+}
+//Complexity: BC=theta(1) WC=theta(maxElem - minElem) AC=theta(1) for dense bags
+
+void DenseBagIterator::first() {
+	occurrence = 0;
+	if (bag.minElem > bag.maxElem) {
+		// nothing was ever added
+		slot = 0;
+		return;
+	}
+	slot = bag.nextSlot(bag.slotIndex(bag.minElem));
+}
+//Complexity: BC=theta(1) WC=AC=theta(maxElem - minElem)
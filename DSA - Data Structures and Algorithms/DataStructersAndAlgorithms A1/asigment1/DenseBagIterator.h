@@ -0,0 +1,20 @@
+#pragma once
+
+#include "DenseBag.h"
+
+class DenseBagIterator
+{
+	friend class DenseBag;
+
+private:
+	const DenseBag& bag; //reference to the container
+	DenseBagIterator(const DenseBag& b); //private constructor of the iterator
+	long long slot; //slot of the current element
+	int occurrence; //how many occurrences of the current element were already returned
+
+public:
+	TElem getCurrent();
+	bool valid();
+	void next();
+	void first();
+};
@@ -2,7 +2,21 @@
 #include <assert.h>
 #include "ExtendedTest.h"
 #include "SetIterator.h"
+#include "ChunkedSet.h"
+#include "ChunkedSetIterator.h"
+#include "ConcurrentSet.h"
+#include "StaticSet.h"
+#include "DenseBag.h"
+#include "DenseBagIterator.h"
+#include "WindowSet.h"
+#include "SetSnapshot.h"
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <climits>
+#include <thread>
+#include <atomic>
+#include <vector>
 
 using namespace std;
 
@@ -295,6 +309,863 @@ void testQuantity() {//add lots of elements
 }
 
 
+void testReserveRange() {
+	cout << "Test reserve range" << endl;
+	Set s;
+	try {
+		s.reserveRange(10, -10);
+		assert(false);
+	}
+	catch (exception&) {
+		assert(true);
+	}
+	s.reserveRange(-1000, 1000); //reserving does not add anything
+	assert(s.isEmpty() == true);
+	assert(s.search(0) == false);
+	SetIterator it = s.iterator();
+	assert(it.valid() == false);
+
+	for (int i = 1000; i >= -1000; i--) {
+		assert(s.add(i) == true);
+	}
+	assert(s.size() == 2001);
+	testIteratorSteps(s);
+
+	for (int i = 0; i < 100000; i++) { //increasing keys past the reserved range
+		s.add(i);
+	}
+	for (int i = 0; i > -100000; i--) { //decreasing keys past the reserved range
+		s.add(i);
+	}
+	assert(s.size() == 199999);
+	assert(s.search(99999) == true);
+	assert(s.search(100000) == false);
+	assert(s.search(-99999) == true);
+	assert(s.search(-100000) == false);
+	testIteratorSteps(s);
+
+	SetIterator it2 = s.iterator(); //elements come out in increasing order
+	TElem previous = it2.getCurrent();
+	assert(previous == -99999);
+	it2.next();
+	while (it2.valid()) {
+		assert(it2.getCurrent() == previous + 1);
+		previous = it2.getCurrent();
+		it2.next();
+	}
+	assert(previous == 99999);
+}
+
+
+void testSetOperations() {
+	cout << "Test set operations" << endl;
+	Set evens; //even numbers of [-1000, 1000]
+	Set threes; //multiples of 3 of [0, 3000)
+	for (int i = -1000; i <= 1000; i = i + 2) {
+		evens.add(i);
+	}
+	for (int i = 0; i < 3000; i = i + 3) {
+		threes.add(i);
+	}
+
+	Set u = Set::unite(evens, threes);
+	Set n = Set::intersect(evens, threes);
+	Set d = Set::subtract(evens, threes);
+	Set x = Set::symmetricDifference(evens, threes);
+	assert(evens.size() == 1001 && threes.size() == 1000); //operands are unchanged
+	for (int i = -1100; i < 3100; i++) {
+		bool inEvens = i >= -1000 && i <= 1000 && i % 2 == 0;
+		bool inThrees = i >= 0 && i < 3000 && i % 3 == 0;
+		assert(u.search(i) == (inEvens || inThrees));
+		assert(n.search(i) == (inEvens && inThrees));
+		assert(d.search(i) == (inEvens && !inThrees));
+		assert(x.search(i) == (inEvens != inThrees));
+	}
+	assert(u.size() == n.size() + x.size());
+	assert(d.size() == evens.size() - n.size());
+	testIteratorSteps(u);
+	testIteratorSteps(n);
+	testIteratorSteps(d);
+	testIteratorSteps(x);
+
+	assert(n.isSubsetOf(evens) == true);
+	assert(n.isSubsetOf(threes) == true);
+	assert(evens.isSubsetOf(u) == true);
+	assert(evens.isSubsetOf(threes) == false);
+	assert(u.isSubsetOf(evens) == false);
+	Set empty;
+	assert(empty.isSubsetOf(evens) == true);
+	assert(evens.isSubsetOf(empty) == false);
+	assert(evens.equals(evens) == true);
+	assert(evens.equals(threes) == false);
+
+	Set copy = evens; //in-place operations give the same results
+	copy.intersect(threes);
+	assert(copy.equals(n) == true);
+	copy.unite(d);
+	assert(copy.equals(evens) == true);
+	copy.symmetricDifference(threes);
+	assert(copy.equals(x) == true);
+	copy.subtract(copy);
+	assert(copy.isEmpty() == true);
+	assert(copy.equals(empty) == true);
+
+	Set far; //operand far away from the set
+	far.add(1000000);
+	copy = evens;
+	copy.intersect(far);
+	assert(copy.isEmpty() == true);
+	copy = evens;
+	copy.unite(far);
+	assert(copy.size() == 1002);
+	assert(copy.search(1000000) == true);
+	testIteratorSteps(copy);
+}
+
+void testSuccessor() {
+	cout << "Test successor" << endl;
+	Set s;
+	assert(s.successor(0) == NULL_TELEM);
+	assert(s.predecessor(0) == NULL_TELEM);
+	for (int i = -500000; i < 500000; i++) { //a wide range, then almost everything is removed
+		s.add(i);
+	}
+	for (int i = -500000; i < 500000; i++) {
+		if ((i % 100000 + 100000) % 100000 != 7) {
+			s.remove(i);
+		}
+	}
+	assert(s.size() == 10);
+	assert(s.successor(-1000000) == -499993);
+	assert(s.successor(7) == 100007);
+	assert(s.successor(6) == 7);
+	assert(s.successor(400007) == NULL_TELEM);
+	assert(s.predecessor(7) == -99993);
+	assert(s.predecessor(8) == 7);
+	assert(s.predecessor(-499993) == NULL_TELEM);
+	assert(s.predecessor(1000000) == 400007);
+
+	SetIterator it = s.iterator();
+	int count = 0;
+	while (it.valid()) { //every step jumps straight to the next element
+		assert((it.getCurrent() % 100000 + 100000) % 100000 == 7);
+		count++;
+		it.next();
+	}
+	assert(count == 10);
+
+	it.seek(0);
+	assert(it.getCurrent() == 7);
+	it.seek(7);
+	assert(it.getCurrent() == 7);
+	it.seek(-1000000);
+	assert(it.getCurrent() == -499993);
+	it.seek(400008);
+	assert(it.valid() == false);
+
+	it.seek(100007); //removing through the iterator keeps the queries right
+	assert(it.remove() == 100007);
+	assert(it.getCurrent() == 200007);
+	assert(s.successor(7) == 200007);
+	assert(s.predecessor(200007) == 7);
+}
+
+void testRanges() {
+	cout << "Test ranges" << endl;
+	Set s;
+	try {
+		s.addRange(5, 4);
+		assert(false);
+	}
+	catch (exception&) {
+		assert(true);
+	}
+	try {
+		s.removeRange(5, 4);
+		assert(false);
+	}
+	catch (exception&) {
+		assert(true);
+	}
+	assert(s.removeRange(-100, 100) == 0); //remove from the empty set
+
+	assert(s.addRange(-1000, 999) == 2000);
+	assert(s.size() == 2000);
+	assert(s.addRange(-1000, 999) == 0);
+	assert(s.addRange(990, 1009) == 10); //overlapping range
+	assert(s.size() == 2010);
+	testIteratorSteps(s);
+
+	assert(s.removeRange(-2000, -991) == 10); //the part outside the set is ignored
+	assert(s.removeRange(-1, 0) == 2);
+	assert(s.size() == 1998);
+	for (int i = -1100; i < 1100; i++) {
+		bool expected = i >= -990 && i <= 1009 && i != -1 && i != 0;
+		assert(s.search(i) == expected);
+	}
+	assert(s.successor(-2) == 1);
+	assert(s.predecessor(1) == -2);
+	testIteratorSteps(s);
+
+	for (int i = -500; i < 500; i = i + 7) { //single removals mixed with ranges
+		s.remove(i);
+	}
+	int remaining = s.size();
+	assert(s.removeRange(-990, 1009) == remaining);
+	assert(s.isEmpty() == true);
+	SetIterator it = s.iterator();
+	assert(it.valid() == false);
+
+	TElem dense[1000]; //addAll with duplicates and elements already present
+	for (int i = 0; i < 1000; i++) {
+		dense[i] = i / 2;
+	}
+	assert(s.addAll(dense, 1000) == 500);
+	assert(s.addAll(dense, 1000) == 0);
+	assert(s.size() == 500);
+	TElem sparse[] = { -1000000, 1000000, 250, 499, 500 };
+	assert(s.addAll(sparse, 5) == 3);
+	assert(s.size() == 503);
+	assert(s.search(-1000000) == true);
+	assert(s.search(1000000) == true);
+	assert(s.successor(500) == 1000000);
+	testIteratorSteps(s);
+	assert(s.addAll(sparse, 0) == 0);
+}
+
+void testShrink() {
+	cout << "Test shrink" << endl;
+	Set s;
+	s.shrinkToFit(); //shrinking the empty set
+	assert(s.isEmpty() == true);
+
+	s.addRange(-1000000, 1000000);
+	assert(s.removeRange(-1000000, 999989) == 1999990); //only the top of the range is left
+	assert(s.size() == 11);
+	assert(s.successor(-2000000) == 999990);
+	assert(s.predecessor(2000000) == 1000000);
+	SetIterator it = s.iterator();
+	assert(it.getCurrent() == 999990);
+	testIteratorSteps(s);
+
+	for (int i = 999990; i <= 1000000; i++) { //the set keeps working after compaction
+		assert(s.search(i) == true);
+	}
+	assert(s.add(-5) == true);
+	assert(s.search(-5) == true);
+	assert(s.remove(-5) == true);
+	s.shrinkToFit();
+	assert(s.size() == 11);
+	testIteratorSteps(s);
+
+	SetIterator it2 = s.iterator(); //removing the minimum through the iterator moves to the next element
+	assert(it2.remove() == 999990);
+	assert(it2.getCurrent() == 999991);
+	while (it2.valid()) {
+		it2.remove();
+	}
+	assert(s.isEmpty() == true);
+	s.shrinkToFit();
+	assert(s.search(999995) == false);
+
+	Set churn; //keys keep moving upwards, old ones are removed
+	for (int round = 0; round < 50; round++) {
+		for (int i = round * 10000; i < (round + 1) * 10000; i++) {
+			churn.add(i);
+		}
+		for (int i = round * 10000; i < (round + 1) * 10000 - 1; i++) {
+			assert(churn.remove(i) == true);
+		}
+		assert(churn.size() == round + 1);
+	}
+	testIteratorSteps(churn);
+	assert(churn.successor(0) == 9999);
+	assert(churn.predecessor(1000000) == 499999);
+
+	Set shared; //removals through one iterator compact the bitmap under another one
+	shared.addRange(0, 199999);
+	SetIterator remover = shared.iterator();
+	SetIterator reader = shared.iterator();
+	reader.seek(195000);
+	while (remover.getCurrent() < 195000) {
+		remover.remove();
+	}
+	assert(remover.getCurrent() == 195000); //the removing iterator finds its position again
+	reader.seek(195000); //the other iterator has to be moved again before it is used
+	int left = 0;
+	while (reader.valid()) {
+		assert(reader.getCurrent() == 195000 + left);
+		reader.next();
+		left++;
+	}
+	assert(left == 5000);
+}
+
+void testSearchMany() {
+	cout << "Test search many" << endl;
+	Set s;
+	TElem keys[100];
+	unsigned char found[100];
+	TWord mask[2];
+	for (int i = 0; i < 100; i++) {
+		keys[i] = (i - 50) * 1000003; //spread over most of the range of TElem
+	}
+	s.searchMany(keys, 100, found); //empty set
+	for (int i = 0; i < 100; i++) {
+		assert(found[i] == 0);
+	}
+
+	for (int i = -20000; i < 20000; i = i + 2) {
+		s.add(i * 1000);
+	}
+	s.add(INT_MAX);
+	for (int i = 0; i < 100; i++) {
+		keys[i] = i % 10 == 0 ? (i - 50) * 1000003 : (i - 50) * 1000 + i % 3;
+	}
+	keys[99] = INT_MAX;
+	keys[98] = INT_MIN;
+	s.searchMany(keys, 100, found);
+	s.searchManyMask(keys, 100, mask);
+	for (int i = 0; i < 100; i++) {
+		assert(found[i] == (s.search(keys[i]) ? 1 : 0));
+		assert(((mask[i / 64] >> (i % 64)) & 1) == found[i]);
+	}
+	assert(found[99] == 1);
+	assert(found[98] == 0);
+	assert(found[50] == 1); //key 0
+	assert(found[54] == 1); //key 4000
+	assert(found[52] == 0); //key 2001
+}
+
+void testToArray() {
+	cout << "Test to array" << endl;
+	Set s;
+	assert(s.toArray(nullptr) == 0);
+	assert(s.toVector().empty() == true);
+
+	s.addRange(-1000, 1000); //full words
+	for (int i = 5000; i < 100000; i = i + 17) {
+		s.add(i);
+	}
+	s.add(INT_MIN);
+	s.add(INT_MAX); //sparse span over the whole range of TElem
+	vector<TElem> elems = s.toVector();
+	assert((int)elems.size() == s.size());
+	TElem* out = new TElem[s.size()];
+	assert(s.toArray(out) == s.size());
+	SetIterator it = s.iterator();
+	for (int i = 0; i < s.size(); i++) {
+		assert(elems[i] == it.getCurrent());
+		assert(out[i] == it.getCurrent());
+		it.next();
+	}
+	assert(it.valid() == false);
+	assert(elems.front() == INT_MIN);
+	assert(elems.back() == INT_MAX);
+	delete[] out;
+}
+
+void testPartitions() {
+	cout << "Test partitions" << endl;
+	Set s;
+	try {
+		s.partitions(0);
+		assert(false);
+	}
+	catch (exception&) {
+		assert(true);
+	}
+	vector<SetIterator> parts = s.partitions(3); //empty set, empty partitions
+	assert(parts.size() == 3);
+	for (SetIterator& it : parts) {
+		assert(it.valid() == false);
+	}
+
+	for (int i = -500000; i < 500000; i = i + 3) {
+		s.add(i);
+	}
+	s.add(INT_MAX);
+	parts = s.partitions(7);
+	assert(parts.size() == 7);
+	long long previous = (long long)INT_MIN - 1;
+	int count = 0;
+	for (SetIterator& it : parts) { //consecutive ranges with balanced sizes
+		int partCount = 0;
+		while (it.valid()) {
+			assert(it.getCurrent() > previous);
+			previous = it.getCurrent();
+			partCount++;
+			it.next();
+		}
+		assert(partCount > s.size() / 7 - 64 && partCount < s.size() / 7 + 64);
+		count += partCount;
+	}
+	assert(count == s.size());
+	assert(previous == INT_MAX);
+
+	parts = s.partitions(s.size() * 2); //more partitions than elements
+	count = 0;
+	for (SetIterator& it : parts) {
+		while (it.valid()) {
+			count++;
+			it.next();
+		}
+	}
+	assert(count == s.size());
+
+	parts = s.partitions(2); //removing through a partition stays inside it
+	TElem split = parts[1].getCurrent();
+	int below = s.rank(split);
+	int before = s.size();
+	SetIterator low = parts[0];
+	while (low.valid()) {
+		low.remove();
+	}
+	assert(s.size() == before - below);
+	assert(s.iterator().getCurrent() == split);
+	assert(s.search(INT_MAX) == true);
+
+	atomic<long long> sum(0);
+	atomic<int> calls(0);
+	s.parallelForEach([&sum, &calls](TElem e) {
+		sum += e;
+		calls++;
+	}, 4);
+	long long expected = 0;
+	SetIterator it = s.iterator();
+	while (it.valid()) {
+		expected += it.getCurrent();
+		it.next();
+	}
+	assert(calls == s.size());
+	assert(sum == expected);
+}
+
+void testRankSelect() {
+	cout << "Test rank select" << endl;
+	Set s;
+	assert(s.rank(0) == 0);
+	assert(s.countInRange(-10, 10) == 0);
+	try {
+		s.select(0);
+		assert(false);
+	}
+	catch (exception&) {
+		assert(true);
+	}
+
+	for (int i = -300000; i < 300000; i = i + 3) { //every third element
+		s.add(i);
+	}
+	assert(s.size() == 200000);
+	for (int k = 0; k < s.size(); k = k + 7) {
+		assert(s.select(k) == -300000 + 3 * k);
+		assert(s.rank(s.select(k)) == k);
+	}
+	assert(s.rank(-300000) == 0);
+	assert(s.rank(-299999) == 1);
+	assert(s.rank(300000) == 200000);
+	assert(s.countInRange(-300000, -300000) == 1);
+	assert(s.countInRange(0, 29) == 10);
+	assert(s.countInRange(-2000000000, 2000000000) == 200000);
+	assert(s.countInRange(INT_MIN, INT_MAX) == 200000);
+	try {
+		s.countInRange(10, 0);
+		assert(false);
+	}
+	catch (exception&) {
+		assert(true);
+	}
+
+	assert(s.remove(0) == true); //the directory follows the changes
+	assert(s.rank(3) == 100000);
+	assert(s.select(100000) == 3);
+	s.addRange(1, 2);
+	assert(s.select(100000) == 1);
+	assert(s.countInRange(-3, 3) == 4);
+	s.removeRange(-300000, -1);
+	assert(s.select(0) == 1);
+	assert(s.rank(INT_MAX) == s.size());
+	try {
+		s.select(s.size());
+		assert(false);
+	}
+	catch (exception&) {
+		assert(true);
+	}
+}
+
+void testChunkedSet() {
+	cout << "Test chunked set" << endl;
+	ChunkedSet s;
+	assert(s.isEmpty() == true);
+	ChunkedSetIterator it = s.iterator();
+	assert(it.valid() == false);
+
+	assert(s.add(-1000000000) == true); //far apart elements only cost their own chunks
+	assert(s.add(1000000000) == true);
+	assert(s.add(1000000000) == false);
+	assert(s.size() == 2);
+	assert(s.search(-1000000000) == true);
+	assert(s.search(0) == false);
+
+	for (int i = -100000; i < 100000; i++) { //dense cluster over several chunks
+		assert(s.add(i) == true);
+	}
+	for (int i = 500000; i < 5000000; i = i + 1000) { //sparse elements
+		assert(s.add(i) == true);
+	}
+	assert(s.size() == 204502);
+	for (int i = -100000; i < 100000; i = i + 3) { //punch holes into the cluster
+		assert(s.remove(i) == true);
+		assert(s.remove(i) == false);
+	}
+	assert(s.size() == 204502 - 66667);
+	for (int i = -100010; i < 100010; i++) {
+		assert(s.search(i) == (i >= -100000 && i < 100000 && (i + 100000) % 3 != 0));
+	}
+
+	ChunkedSetIterator it2 = s.iterator(); //elements come out in increasing order
+	int count = 0;
+	long long previous = -2000000000LL;
+	while (it2.valid()) {
+		assert(it2.getCurrent() > previous);
+		previous = it2.getCurrent();
+		count++;
+		it2.next();
+	}
+	assert(count == s.size());
+	assert(previous == 1000000000);
+
+	it2.first();
+	assert(it2.getCurrent() == -1000000000);
+	while (it2.valid()) { //remove everything through the iterator
+		TElem e = it2.remove();
+		assert(s.search(e) == false);
+	}
+	assert(s.isEmpty() == true);
+	try {
+		it2.remove();
+		assert(false);
+	}
+	catch (exception&) {
+		assert(true);
+	}
+}
+
+void testConcurrentSet() {
+	cout << "Test concurrent set" << endl;
+	try {
+		ConcurrentSet wrong(10, 0);
+		assert(false);
+	}
+	catch (exception&) {
+		assert(true);
+	}
+	ConcurrentSet s(-100000, 100000);
+	assert(s.isEmpty() == true);
+	assert(s.search(0) == false);
+	assert(s.remove(200000) == false);
+	try {
+		s.add(100001);
+		assert(false);
+	}
+	catch (exception&) {
+		assert(true);
+	}
+
+	const int threads = 4;
+	vector<thread> workers;
+	for (int t = 0; t < threads; t++) { //every thread adds every element, each one is counted once
+		workers.push_back(thread([&s]() {
+			for (int i = -100000; i <= 100000; i++) {
+				s.add(i);
+			}
+		}));
+	}
+	for (thread& w : workers) {
+		w.join();
+	}
+	assert(s.size() == 200001);
+
+	workers.clear();
+	for (int t = 0; t < threads; t++) { //the threads remove disjoint thirds, interleaved inside the same words
+		workers.push_back(thread([&s, t]() {
+			for (int i = -100000 + t; i <= 100000; i = i + threads) {
+				if ((i + 100000) % 3 == 0)
+					assert(s.remove(i) == true);
+			}
+		}));
+	}
+	for (thread& w : workers) {
+		w.join();
+	}
+	assert(s.size() == 200001 - 66667);
+	for (int i = -100000; i <= 100000; i++) {
+		assert(s.search(i) == ((i + 100000) % 3 != 0));
+	}
+
+	Set copy = s.toSet();
+	assert(copy.size() == s.size());
+	assert(copy.search(-99999) == true);
+	assert(copy.search(-100000) == false);
+	assert(copy.predecessor(INT_MAX) == 100000);
+}
+
+void testStaticSet() {
+	cout << "Test static set" << endl;
+	constexpr StaticSet<0, 65535> ports{ 80, 443, 8080, 443 }; //built by the compiler
+	static_assert(ports.size() == 3, "ports are counted once");
+	static_assert(ports.search(443) && !ports.search(444), "ports are searched at compile time");
+	assert(ports.search(-1) == false);
+	assert(ports.search(65536) == false);
+
+	StaticSet<-100, 100> s;
+	assert(s.isEmpty() == true);
+	StaticSetIterator<-100, 100> it = s.iterator();
+	assert(it.valid() == false);
+	try {
+		s.add(101);
+		assert(false);
+	}
+	catch (exception&) {
+		assert(true);
+	}
+	for (int i = -100; i <= 100; i = i + 2) {
+		assert(s.add(i) == true);
+		assert(s.add(i) == false);
+	}
+	assert(s.size() == 101);
+	for (int i = -150; i <= 150; i++) {
+		assert(s.search(i) == (i >= -100 && i <= 100 && i % 2 == 0));
+	}
+	assert(s.remove(-100) == true);
+	assert(s.remove(-100) == false);
+	assert(s.remove(1000) == false);
+
+	it.first(); //same protocol as SetIterator
+	assert(it.getCurrent() == -98);
+	int count = 0;
+	while (it.valid()) {
+		assert(it.getCurrent() % 2 == 0);
+		count++;
+		it.next();
+	}
+	assert(count == s.size());
+	it.seek(51);
+	assert(it.getCurrent() == 52);
+	it.seek(-1000);
+	assert(it.getCurrent() == -98);
+	it.seek(101);
+	assert(it.valid() == false);
+
+	it.first();
+	while (it.valid()) {
+		TElem e = it.remove();
+		assert(s.search(e) == false);
+	}
+	assert(s.isEmpty() == true);
+}
+
+void testDenseBag() {
+	cout << "Test dense bag" << endl;
+	DenseBag b;
+	assert(b.isEmpty() == true);
+	assert(b.remove(5) == false);
+	assert(b.nrOccurrences(5) == 0);
+	DenseBagIterator it = b.iterator();
+	assert(it.valid() == false);
+
+	for (int i = 0; i < 1000; i++) { //a heavy key goes past the small counters
+		b.add(7);
+	}
+	b.add(-3);
+	b.add(-3);
+	b.add(100000);
+	assert(b.size() == 1003);
+	assert(b.nrOccurrences(7) == 1000);
+	assert(b.nrOccurrences(-3) == 2);
+	assert(b.search(100000) == true);
+	assert(b.search(99999) == false);
+
+	it.first(); //increasing order, with repetitions
+	assert(it.getCurrent() == -3);
+	it.next();
+	assert(it.getCurrent() == -3);
+	it.next();
+	for (int i = 0; i < 1000; i++) {
+		assert(it.getCurrent() == 7);
+		it.next();
+	}
+	assert(it.getCurrent() == 100000);
+	it.next();
+	assert(it.valid() == false);
+	try {
+		it.next();
+		assert(false);
+	}
+	catch (exception&) {
+		assert(true);
+	}
+
+	for (int i = 1000; i > 0; i--) {
+		assert(b.nrOccurrences(7) == i);
+		assert(b.remove(7) == true);
+	}
+	assert(b.remove(7) == false);
+	assert(b.search(7) == false);
+	assert(b.size() == 3);
+
+	for (int i = -50000; i < 50000; i++) { //dense keys, growing on both sides
+		b.add(i);
+		if (i % 5 == 0)
+			b.add(i);
+	}
+	assert(b.size() == 3 + 100000 + 20000);
+	int count = 0;
+	long long previous = INT_MIN;
+	it.first();
+	while (it.valid()) {
+		assert(it.getCurrent() >= previous);
+		previous = it.getCurrent();
+		count++;
+		it.next();
+	}
+	assert(count == b.size());
+	assert(previous == 100000);
+}
+
+void testWindowSet() {
+	cout << "Test window set" << endl;
+	try {
+		WindowSet wrong(0);
+		assert(false);
+	}
+	catch (exception&) {
+		assert(true);
+	}
+	WindowSet s(1000);
+	assert(s.isEmpty() == true);
+	assert(s.windowStart() == NULL_TELEM);
+	assert(s.search(0) == false);
+
+	for (int i = 0; i < 1000; i++) {
+		assert(s.add(i) == true);
+	}
+	assert(s.add(500) == false);
+	assert(s.size() == 1000);
+	assert(s.windowStart() == 0);
+
+	assert(s.add(1100) == true); //the window slides, [0, 100] expires
+	assert(s.windowStart() == 101);
+	assert(s.size() == 900); //899 old elements and 1100
+	assert(s.search(100) == false);
+	assert(s.search(101) == true);
+	assert(s.add(50) == false); //too old
+	assert(s.add(1050) == true); //late but inside the window
+	assert(s.remove(1050) == true);
+	assert(s.remove(1050) == false);
+
+	for (int i = 2000; i < 10000000; i = i + 3) { //a long stream keeps the size bounded
+		s.add(i);
+		assert(s.size() <= 334);
+	}
+	assert(s.search(9999998) == true);
+	assert(s.search(9999998 - 999) == true);
+	assert(s.search(9999998 - 1002) == false); //was added, but expired
+
+	assert(s.add(2000000000) == true); //a jump past the whole window drops everything
+	assert(s.size() == 1);
+	assert(s.search(9999998) == false);
+	assert(s.add(INT_MAX) == true);
+	assert(s.windowStart() == INT_MAX - 999);
+	assert(s.size() == 1);
+}
+
+void testSnapshot() {
+	cout << "Test snapshot" << endl;
+	const char* path = "snapshot_test.bin";
+	Set s;
+	SetSnapshot empty = s.snapshot();
+	assert(empty.isEmpty() == true);
+	empty.writeTo(path);
+	assert(Set::load(path).isEmpty() == true);
+
+	for (int i = -100000; i < 100000; i = i + 3) {
+		s.add(i);
+	}
+	SetSnapshot view = s.snapshot();
+	assert(view.size() == s.size());
+
+	s.add(1); //the set changes, the snapshot does not
+	assert(s.remove(0) == false);
+	assert(s.remove(-99997) == true);
+	s.addRange(-5000, 5000);
+	s.removeRange(50000, 60000);
+	assert(view.search(1) == false);
+	assert(view.search(-99997) == true);
+	assert(view.search(50001) == false);
+	assert(view.search(50000) == true);
+	s.add(10000000); //the bitmap is reallocated
+	s.add(-10000000);
+	assert(s.search(-10000000) == true);
+	assert(view.search(-10000000) == false);
+	for (int i = -100010; i < 100010; i++) {
+		assert(view.search(i) == (i >= -100000 && i < 100000 && (i + 100000) % 3 == 0));
+	}
+
+	view.writeTo(path);
+	Set loaded = Set::load(path);
+	assert(loaded.size() == view.size());
+	SetIterator it = loaded.iterator();
+	int count = 0;
+	while (it.valid()) {
+		assert((it.getCurrent() + 100000) % 3 == 0);
+		count++;
+		it.next();
+	}
+	assert(count == view.size());
+	assert(loaded.successor(-100001) == -100000);
+
+	SetSnapshot later = s.snapshot(); //a new snapshot, the old one keeps its elements
+	thread writer([&later, path]() {
+		later.writeTo(path);
+	});
+	for (int i = 0; i < 200000; i++) { //the set keeps changing while the snapshot is written
+		s.remove(i - 100000);
+	}
+	writer.join();
+	Set loadedLater = Set::load(path);
+	assert(loadedLater.size() == later.size());
+	assert(loadedLater.search(10000000) == true);
+	assert(loadedLater.search(1) == true);
+	assert(view.search(-99997) == true);
+	assert(s.search(1) == false);
+
+	fstream file(path, ios::in | ios::out | ios::binary); //a size in the header that does not match the words is rejected
+	int wrongLength = later.size() + 1;
+	file.seekp(8 + 2 * sizeof(int));
+	file.write((const char*)&wrongLength, sizeof(wrongLength));
+	file.close();
+	try {
+		Set::load(path);
+		assert(false);
+	}
+	catch (exception&) {
+		assert(true);
+	}
+
+	std::remove(path);
+	try {
+		Set::load(path);
+		assert(false);
+	}
+	catch (exception&) {
+		assert(true);
+	}
+}
+
+
 // we don't know how the set is represented and in which order the elements are stored or printed, we can only test general thing
 void testAllExtended() {
 	testCreate();
@@ -303,6 +1174,21 @@ void testAllExtended() {
 	testIterator();
 	testMix();
 	testQuantity();
+	testReserveRange();
+	testSetOperations();
+	testSuccessor();
+	testRanges();
+	testShrink();
+	testSearchMany();
+	testToArray();
+	testPartitions();
+	testRankSelect();
+	testChunkedSet();
+	testConcurrentSet();
+	testStaticSet();
+	testDenseBag();
+	testWindowSet();
+	testSnapshot();
 
 }
 
@@ -1,82 +1,782 @@
 #include "Set.h"
 #include "SetIterator.h"
+#include "WordKernels.h"
+#include "SetSnapshot.h"
 #include <iostream>
 #include <exception>
+#include <algorithm>
+#include <climits>
+#include <thread>
 using namespace std;
 
+// bitmaps of at most this many words are never compacted
+static const int MIN_COMPACT_WORDS = 64;
+
+// index of the word holding bit, rounding down for negative bits
+static long long wordOf(long long bit) {
+    return bit >= 0 ? bit / WORD_BITS : (bit - (WORD_BITS - 1)) / WORD_BITS;
+}
+//Complexity: BC=WC=AC=theta(1)
+
 Set::Set() {
 	minElem = 0;
 	maxElem = -1;
+	base = 0;
 	capacity = 0;
-	elements = nullptr;
+	words = nullptr;
 	length = 0;
+	summaryLevels = 0;
+	blockRank = nullptr;
+	selectHint = nullptr;
+	rankDirty = true;
 }
 //Complexity: BC=WC=AC=theta(1)
 
-bool Set::add(TElem e) {
-    if (capacity == 0) {
-        // First element
-        capacity = 1;
-        elements = new bool[1];
-        elements[0] = true;
-        minElem = e;
-        maxElem = e;
-        length = 1;
-        return true;
+Set::Set(const Set& other) {
+    minElem = other.minElem;
+    maxElem = other.maxElem;
+    base = other.base;
+    capacity = other.capacity;
+    length = other.length;
+    words = nullptr;
+    summaryLevels = 0;
+    blockRank = nullptr;
+    selectHint = nullptr;
+    rankDirty = true;
+    if (capacity > 0) {
+        words = new TWord[capacity];
+        for (int k = 0; k < capacity; ++k) {
+            words[k] = other.words[k];
+        }
+    }
+    buildSummary();
+}
+//Complexity: BC=WC=AC=theta(capacity)
+
+Set& Set::operator=(const Set& other) {
+    if (this == &other)
+        return *this;
+    detachSnapshot();
+
+    TWord* newWords = nullptr;
+    if (other.capacity > 0) {
+        newWords = new TWord[other.capacity];
+        for (int k = 0; k < other.capacity; ++k) {
+            newWords[k] = other.words[k];
+        }
     }
+    delete[] words;
+    words = newWords;
+    minElem = other.minElem;
+    maxElem = other.maxElem;
+    base = other.base;
+    capacity = other.capacity;
+    length = other.length;
+    buildSummary();
+    rankDirty = true;
+    return *this;
+}
+//Complexity: BC=WC=AC=theta(capacity)
 
-    if (e < minElem || e > maxElem) {
-        // Resize array to fit new range
-        int newMin = min(minElem, e);
-        int newMax = max(maxElem, e);
-        int newCapacity = newMax - newMin + 1;
-        bool* newElements = new bool[newCapacity] {false};
+long long Set::bitIndex(TElem e) const {
+    return (long long)e - base;
+}
+//Complexity: BC=WC=AC=theta(1)
 
-        for (int i = minElem; i <= maxElem; ++i) {
-            newElements[i - newMin] = elements[i - minElem];
+bool Set::covers(TElem lo, TElem hi) const {
+    return capacity > 0 && lo >= base && bitIndex(hi) < (long long)capacity * WORD_BITS;
+}
+//Complexity: BC=WC=AC=theta(1)
+
+void Set::grow(TElem lo, TElem hi, bool geometric) {
+    long long newBase = base;
+    long long newCapacity = capacity;
+    growRange(newBase, newCapacity, lo, hi, WORD_BITS, geometric);
+    resize((int)newBase, (int)newCapacity);
+}
+//Complexity: BC=WC=AC=theta(capacity)
+
+void Set::resize(int newBase, int newCapacity) {
+    detachSnapshot();
+    TWord* newWords = new TWord[newCapacity]{ 0 };
+    if (capacity > 0) {
+        // when shrinking only the words that fit in the new bitmap are kept
+        int offset = (int)(((long long)base - newBase) / WORD_BITS);
+        int from = max(0, -offset);
+        int to = min(capacity, newCapacity - offset);
+        for (int k = from; k < to; ++k) {
+            newWords[k + offset] = words[k];
         }
+    }
+
+    delete[] words;
+    words = newWords;
+    capacity = newCapacity;
+    base = newBase;
+    buildSummary();
+    rankDirty = true;
+}
+//Complexity: BC=WC=AC=theta(newCapacity)
+
+void Set::buildSummary() {
+    freeSummary();
+    long long bits = capacity;
+    while (bits > 0) {
+        int n = (int)((bits + WORD_BITS - 1) / WORD_BITS);
+        summary[summaryLevels] = new TWord[n]{ 0 };
+        summaryWords[summaryLevels] = n;
+        summaryLevels++;
+        if (n == 1)
+            break;
+        bits = n;
+    }
+    if (capacity > 0)
+        refreshSummary(0, capacity - 1);
+}
+//Complexity: BC=WC=AC=theta(capacity)
+
+void Set::freeSummary() {
+    for (int l = 0; l < summaryLevels; l++) {
+        delete[] summary[l];
+    }
+    summaryLevels = 0;
+}
+//Complexity: BC=WC=AC=theta(summaryLevels)
+
+void Set::refreshSummary(int first, int last) {
+    const TWord* below = words;
+    long long belowCount = capacity;
+    long long lo = first;
+    long long hi = last;
+    for (int l = 0; l < summaryLevels; l++) {
+        // whole summary words are recomputed from the level below
+        for (long long j = lo / WORD_BITS; j <= hi / WORD_BITS; j++) {
+            TWord word = 0;
+            long long end = min((j + 1) * WORD_BITS, belowCount);
+            for (long long i = j * WORD_BITS; i < end; i++) {
+                word |= (TWord)(below[i] != 0) << (i % WORD_BITS);
+            }
+            summary[l][j] = word;
+        }
+        below = summary[l];
+        belowCount = summaryWords[l];
+        lo /= WORD_BITS;
+        hi /= WORD_BITS;
+    }
+}
+//Complexity: BC=WC=AC=theta(last - first + WORD_BITS * summaryLevels)
+
+void Set::markWord(int k) {
+    long long i = k;
+    for (int l = 0; l < summaryLevels; l++) {
+        TWord& word = summary[l][i / WORD_BITS];
+        bool wasEmpty = word == 0;
+        word |= 1ULL << (i % WORD_BITS);
+        if (!wasEmpty)
+            return;
+        i /= WORD_BITS;
+    }
+}
+//Complexity: BC=theta(1) WC=AC=theta(summaryLevels)
+
+void Set::unmarkWord(int k) {
+    long long i = k;
+    for (int l = 0; l < summaryLevels; l++) {
+        TWord& word = summary[l][i / WORD_BITS];
+        word &= ~(1ULL << (i % WORD_BITS));
+        if (word != 0)
+            return;
+        i /= WORD_BITS;
+    }
+}
+//Complexity: BC=theta(1) WC=AC=theta(summaryLevels)
+
+long long Set::nextSummaryBit(int level, long long i) const {
+    if (i >= (long long)summaryWords[level] * WORD_BITS)
+        return -1;
+    long long k = i / WORD_BITS;
+    TWord word = summary[level][k] & (ALL_ONES << (i % WORD_BITS));
+    if (word != 0)
+        return k * WORD_BITS + countTrailingZeros(word);
+    if (level + 1 == summaryLevels)
+        return -1;
+
+    // the level above tells which later word of this level is non-zero
+    long long j = nextSummaryBit(level + 1, k + 1);
+    if (j < 0)
+        return -1;
+    return j * WORD_BITS + countTrailingZeros(summary[level][j]);
+}
+//Complexity: BC=theta(1) WC=AC=theta(summaryLevels)
+
+long long Set::prevSummaryBit(int level, long long i) const {
+    if (i < 0)
+        return -1;
+    long long k = i / WORD_BITS;
+    TWord word = summary[level][k] & (ALL_ONES >> (WORD_BITS - 1 - i % WORD_BITS));
+    if (word != 0)
+        return k * WORD_BITS + highestBit(word);
+    if (level + 1 == summaryLevels)
+        return -1;
+
+    long long j = prevSummaryBit(level + 1, k - 1);
+    if (j < 0)
+        return -1;
+    return j * WORD_BITS + highestBit(summary[level][j]);
+}
+//Complexity: BC=theta(1) WC=AC=theta(summaryLevels)
+
+long long Set::nextBit(long long from) const {
+    from = max(from, 0LL);
+    if (from >= (long long)capacity * WORD_BITS)
+        return -1;
+    long long k = from / WORD_BITS;
+    TWord word = words[k] & (ALL_ONES << (from % WORD_BITS));
+    if (word != 0)
+        return k * WORD_BITS + countTrailingZeros(word);
+
+    long long j = nextSummaryBit(0, k + 1);
+    if (j < 0)
+        return -1;
+    return j * WORD_BITS + countTrailingZeros(words[j]);
+}
+//Complexity: BC=theta(1) WC=AC=theta(summaryLevels)
+
+long long Set::prevBit(long long from) const {
+    from = min(from, (long long)capacity * WORD_BITS - 1);
+    if (from < 0)
+        return -1;
+    long long k = from / WORD_BITS;
+    TWord word = words[k] & (ALL_ONES >> (WORD_BITS - 1 - from % WORD_BITS));
+    if (word != 0)
+        return k * WORD_BITS + highestBit(word);
+
+    long long j = prevSummaryBit(0, k - 1);
+    if (j < 0)
+        return -1;
+    return j * WORD_BITS + highestBit(words[j]);
+}
+//Complexity: BC=theta(1) WC=AC=theta(summaryLevels)
+
+long long Set::setBits(long long from, long long to) {
+    long long first = from / WORD_BITS;
+    long long last = to / WORD_BITS;
+    beforeWrite(first, last);
+    TWord firstMask = ALL_ONES << (from % WORD_BITS);
+    TWord lastMask = ALL_ONES >> (WORD_BITS - 1 - to % WORD_BITS);
+    if (first == last) {
+        TWord before = words[first];
+        words[first] |= firstMask & lastMask;
+        return popCount(words[first]) - popCount(before);
+    }
+
+    long long delta = popCount(words[first] | firstMask) - popCount(words[first]);
+    words[first] |= firstMask;
+    delta += popCount(words[last] | lastMask) - popCount(words[last]);
+    words[last] |= lastMask;
+
+    // the words in between are filled completely
+    int middle = (int)(last - first - 1);
+    delta += (long long)middle * WORD_BITS - countWords(words + first + 1, middle);
+    fill(words + first + 1, words + last, ALL_ONES);
+    return delta;
+}
+//Complexity: BC=WC=AC=theta((to - from) / WORD_BITS)
+
+long long Set::clearBits(long long from, long long to) {
+    long long first = from / WORD_BITS;
+    long long last = to / WORD_BITS;
+    beforeWrite(first, last);
+    TWord firstMask = ALL_ONES << (from % WORD_BITS);
+    TWord lastMask = ALL_ONES >> (WORD_BITS - 1 - to % WORD_BITS);
+    if (first == last) {
+        TWord before = words[first];
+        words[first] &= ~(firstMask & lastMask);
+        return popCount(words[first]) - popCount(before);
+    }
+
+    long long delta = popCount(words[first] & ~firstMask) - popCount(words[first]);
+    words[first] &= ~firstMask;
+    delta += popCount(words[last] & ~lastMask) - popCount(words[last]);
+    words[last] &= ~lastMask;
+    delta += clearWords(words + first + 1, (int)(last - first - 1));
+    return delta;
+}
+//Complexity: BC=WC=AC=theta((to - from) / WORD_BITS)
+
+void Set::widen(TElem lo, TElem hi) {
+    if (minElem > maxElem) {
+        // First element
+        minElem = lo;
+        maxElem = hi;
+    }
+    else {
+        minElem = min(minElem, lo);
+        maxElem = max(maxElem, hi);
+    }
+}
+//Complexity: BC=WC=AC=theta(1)
 
-        delete[] elements;
-        elements = newElements;
-        capacity = newCapacity;
-        minElem = newMin;
-        maxElem = newMax;
+void Set::tighten() {
+    if (length == 0) {
+        minElem = 0;
+        maxElem = -1;
+        return;
     }
+    minElem = (TElem)(base + nextBit(bitIndex(minElem)));
+    maxElem = (TElem)(base + prevBit(bitIndex(maxElem)));
+}
+//Complexity: BC=WC=AC=theta(summaryLevels)
+
+void Set::compact() {
+    if (capacity <= MIN_COMPACT_WORDS)
+        return;
+    if (length == 0) {
+        shrinkToFit();
+        return;
+    }
+
+    long long used = wordOf(bitIndex(maxElem)) - wordOf(bitIndex(minElem)) + 1;
+    if (used * 4 >= capacity)
+        return;
 
-    int index = e - minElem;
+    // keep room for the range to double again before the next resize, half of it on each side
+    long long newCapacity = max(used * 2, (long long)MIN_COMPACT_WORDS);
+    long long newBase = (minElem & ~(WORD_BITS - 1)) - (newCapacity - used) / 2 * WORD_BITS;
+    newBase = max(newBase, (long long)INT_MIN);
+    newCapacity = min(newCapacity, ((long long)INT_MAX - newBase) / WORD_BITS + 1);
+    resize((int)newBase, (int)newCapacity);
+}
+//Complexity: BC=theta(1) WC=AC=theta(maxElem - minElem) amortized
+
+void Set::shrinkToFit() {
+    if (length == 0) {
+        detachSnapshot();
+        delete[] words;
+        words = nullptr;
+        capacity = 0;
+        base = 0;
+        freeSummary();
+        tighten();
+        return;
+    }
+    int newBase = minElem & ~(WORD_BITS - 1);
+    resize(newBase, (int)(((long long)maxElem - newBase) / WORD_BITS + 1));
+}
+//Complexity: BC=WC=AC=theta(capacity)
+
+void Set::reserveRange(TElem lo, TElem hi) {
+    if (lo > hi)
+        throw exception();
+    if (!covers(lo, hi))
+        grow(lo, hi, false);
+}
+//Complexity: BC=theta(1) WC=AC=theta(hi - lo + capacity)
 
-    if (elements[index])
+bool Set::add(TElem e) {
+    if (!covers(e, e)) {
+        // the capacity at least doubles, so extending the range is amortized theta(1)
+        grow(e, e, true);
+    }
+
+    widen(e, e);
+
+    long long index = bitIndex(e);
+    TWord mask = 1ULL << (index % WORD_BITS);
+    TWord& word = words[index / WORD_BITS];
+
+    if (word & mask)
         return false; // already in set
 
-    elements[index] = true;
+    beforeWrite(index / WORD_BITS, index / WORD_BITS);
+    if (word == 0)
+        markWord((int)(index / WORD_BITS));
+    word |= mask;
     length++;
+    rankDirty = true;
     return true;
 }
-//Complexity: BC=theta(1) WC=AC=theta(capacity)
+//Complexity: BC=theta(1) WC=theta(capacity) AC=theta(1) amortized
+
 
+int Set::addRange(TElem lo, TElem hi) {
+    if (lo > hi)
+        throw exception();
+    if (!covers(lo, hi))
+        grow(lo, hi, true);
+    widen(lo, hi);
+
+    int added = (int)setBits(bitIndex(lo), bitIndex(hi));
+    length += added;
+    rankDirty = true;
+    refreshSummary((int)(bitIndex(lo) / WORD_BITS), (int)(bitIndex(hi) / WORD_BITS));
+    return added;
+}
+//Complexity: BC=WC=AC=theta((hi - lo) / WORD_BITS) amortized
+
+int Set::addAll(const TElem* elems, int n) {
+    if (n <= 0)
+        return 0;
+
+    TElem lo = elems[0];
+    TElem hi = elems[0];
+    for (int i = 1; i < n; i++) {
+        lo = min(lo, elems[i]);
+        hi = max(hi, elems[i]);
+    }
+    if (!covers(lo, hi))
+        grow(lo, hi, true);
+    widen(lo, hi);
+
+    int first = (int)(bitIndex(lo) / WORD_BITS);
+    int last = (int)(bitIndex(hi) / WORD_BITS);
+    if (last - first < n) {
+        // dense input: set the bits blindly and count the whole span once
+        long long before = countWords(words + first, last - first + 1);
+        beforeWrite(first, last);
+        for (int i = 0; i < n; i++) {
+            long long index = bitIndex(elems[i]);
+            words[index / WORD_BITS] |= 1ULL << (index % WORD_BITS);
+        }
+        int added = (int)(countWords(words + first, last - first + 1) - before);
+        length += added;
+        rankDirty = true;
+        refreshSummary(first, last);
+        return added;
+    }
+
+    // sparse input: the span is wider than the input, so only the touched words are visited
+    int added = 0;
+    for (int i = 0; i < n; i++) {
+        long long index = bitIndex(elems[i]);
+        TWord mask = 1ULL << (index % WORD_BITS);
+        TWord& word = words[index / WORD_BITS];
+        if (word & mask)
+            continue;
+        beforeWrite(index / WORD_BITS, index / WORD_BITS);
+        if (word == 0)
+            markWord((int)(index / WORD_BITS));
+        word |= mask;
+        added++;
+    }
+    length += added;
+    rankDirty = true;
+    return added;
+}
+//Complexity: BC=WC=AC=theta(n + min(n, (hi - lo) / WORD_BITS)) amortized
 
 bool Set::remove(TElem elem) {
     if (elem < minElem || elem > maxElem)
         return false;
 
-    int index = elem - minElem;
-    if (!elements[index])
+    long long index = bitIndex(elem);
+    TWord mask = 1ULL << (index % WORD_BITS);
+    TWord& word = words[index / WORD_BITS];
+    if (!(word & mask))
         return false;
 
-    elements[index] = false;
+    beforeWrite(index / WORD_BITS, index / WORD_BITS);
+    word &= ~mask;
+    if (word == 0)
+        unmarkWord((int)(index / WORD_BITS));
     length--;
+    rankDirty = true;
 
+    if (elem == minElem || elem == maxElem) {
+        tighten();
+        compact();
+    }
     return true;
 }
-//Complexity: BC=theta(1), WC=theta(1), AC=theta(1)
+//Complexity: BC=theta(1), WC=theta(maxElem - minElem), AC=theta(1) amortized
+
+int Set::removeRange(TElem lo, TElem hi) {
+    if (lo > hi)
+        throw exception();
+    lo = max(lo, minElem);
+    hi = min(hi, maxElem);
+    if (lo > hi)
+        return 0;
+
+    int removed = (int)-clearBits(bitIndex(lo), bitIndex(hi));
+    length -= removed;
+    rankDirty = true;
+    refreshSummary((int)(bitIndex(lo) / WORD_BITS), (int)(bitIndex(hi) / WORD_BITS));
+    tighten();
+    compact();
+    return removed;
+}
+//Complexity: BC=theta(1) WC=AC=theta((hi - lo) / WORD_BITS)
 
 bool Set::search(TElem elem) const {
     if (elem < minElem || elem > maxElem)
         return false;
-    return elements[elem - minElem];
+    long long index = bitIndex(elem);
+    return (words[index / WORD_BITS] >> (index % WORD_BITS)) & 1;
 }
 //Complexity: BC=theta(1), WC=theta(1), AC=theta(1)
 
+void Set::searchMany(const TElem* keys, int n, unsigned char* out) const {
+    if (length == 0) {
+        for (int i = 0; i < n; i++) {
+            out[i] = 0;
+        }
+        return;
+    }
+    testBits(words, base, minElem, maxElem, keys, n, out);
+}
+//Complexity: BC=WC=AC=theta(n)
+
+void Set::searchManyMask(const TElem* keys, int n, TWord* out) const {
+    if (length == 0) {
+        for (int k = 0; k < (n + WORD_BITS - 1) / WORD_BITS; k++) {
+            out[k] = 0;
+        }
+        return;
+    }
+    testBitsMask(words, base, minElem, maxElem, keys, n, out);
+}
+//Complexity: BC=WC=AC=theta(n)
+
+
+bool Set::overlap(const Set& other, int& first, int& last, int& offset) const {
+    if (capacity == 0 || other.minElem > other.maxElem)
+        return false;
+
+    long long lo = max(wordOf(bitIndex(other.minElem)), 0LL);
+    long long hi = min(wordOf(bitIndex(other.maxElem)), capacity - 1LL);
+    if (lo > hi)
+        return false;
+
+    // both bases are multiples of WORD_BITS, so the two bitmaps differ by a whole number of words
+    first = (int)lo;
+    last = (int)hi;
+    offset = (int)(((long long)base - other.base) / WORD_BITS);
+    return true;
+}
+//Complexity: BC=WC=AC=theta(1)
+
+void Set::unite(const Set& other) {
+    if (other.minElem > other.maxElem)
+        return;
+    if (!covers(other.minElem, other.maxElem))
+        grow(other.minElem, other.maxElem, true);
+    widen(other.minElem, other.maxElem);
+
+    int first, last, offset;
+    overlap(other, first, last, offset);
+    beforeWrite(first, last);
+    length += (int)orWords(words + first, other.words + first + offset, last - first + 1);
+    rankDirty = true;
+    refreshSummary(first, last);
+}
+//Complexity: BC=WC=AC=theta(other.maxElem - other.minElem) amortized
+
+void Set::intersect(const Set& other) {
+    beforeWrite(0, capacity - 1);
+    int first, last, offset;
+    if (!overlap(other, first, last, offset)) {
+        length += (int)clearWords(words, capacity);
+        rankDirty = true;
+        if (capacity > 0)
+            refreshSummary(0, capacity - 1);
+        tighten();
+        compact();
+        return;
+    }
+
+    // the words outside the range of other can not keep any element
+    length += (int)clearWords(words, first);
+    length += (int)clearWords(words + last + 1, capacity - last - 1);
+    length += (int)andWords(words + first, other.words + first + offset, last - first + 1);
+    rankDirty = true;
+    refreshSummary(0, capacity - 1);
+    tighten();
+    compact();
+}
+//Complexity: BC=WC=AC=theta(capacity)
+
+void Set::subtract(const Set& other) {
+    int first, last, offset;
+    if (!overlap(other, first, last, offset))
+        return;
+    beforeWrite(first, last);
+    length += (int)andNotWords(words + first, other.words + first + offset, last - first + 1);
+    rankDirty = true;
+    refreshSummary(first, last);
+    tighten();
+    compact();
+}
+//Complexity: BC=theta(1) WC=AC=theta(min(capacity, other.maxElem - other.minElem))
+
+void Set::symmetricDifference(const Set& other) {
+    if (other.minElem > other.maxElem)
+        return;
+    if (!covers(other.minElem, other.maxElem))
+        grow(other.minElem, other.maxElem, true);
+    widen(other.minElem, other.maxElem);
+
+    int first, last, offset;
+    overlap(other, first, last, offset);
+    beforeWrite(first, last);
+    length += (int)xorWords(words + first, other.words + first + offset, last - first + 1);
+    rankDirty = true;
+    refreshSummary(first, last);
+    tighten();
+    compact();
+}
+//Complexity: BC=WC=AC=theta(other.maxElem - other.minElem) amortized
+
+Set Set::unite(const Set& a, const Set& b) {
+    Set result(a);
+    result.unite(b);
+    return result;
+}
+//Complexity: BC=WC=AC=theta(a.capacity + b.maxElem - b.minElem)
+
+Set Set::intersect(const Set& a, const Set& b) {
+    Set result(a);
+    result.intersect(b);
+    return result;
+}
+//Complexity: BC=WC=AC=theta(a.capacity)
+
+Set Set::subtract(const Set& a, const Set& b) {
+    Set result(a);
+    result.subtract(b);
+    return result;
+}
+//Complexity: BC=WC=AC=theta(a.capacity)
+
+Set Set::symmetricDifference(const Set& a, const Set& b) {
+    Set result(a);
+    result.symmetricDifference(b);
+    return result;
+}
+//Complexity: BC=WC=AC=theta(a.capacity + b.maxElem - b.minElem)
+
+TElem Set::successor(TElem e) const {
+    if (e >= maxElem)
+        return NULL_TELEM;
+    long long bit = nextBit(bitIndex(e) + 1);
+    return bit < 0 ? NULL_TELEM : (TElem)(base + bit);
+}
+//Complexity: BC=theta(1) WC=AC=theta(summaryLevels)
+
+TElem Set::predecessor(TElem e) const {
+    if (e <= minElem)
+        return NULL_TELEM;
+    long long bit = prevBit(bitIndex(e) - 1);
+    return bit < 0 ? NULL_TELEM : (TElem)(base + bit);
+}
+//Complexity: BC=theta(1) WC=AC=theta(summaryLevels)
+
+void Set::buildRank() const {
+    delete[] blockRank;
+    delete[] selectHint;
+    int blocks = (capacity + RANK_BLOCK_WORDS - 1) / RANK_BLOCK_WORDS;
+    blockRank = new int[blocks + 1];
+    selectHint = new int[length / SELECT_SAMPLE + 1];
+
+    int count = 0;
+    int hint = 0;
+    for (int b = 0; b < blocks; b++) {
+        blockRank[b] = count;
+        int end = min(capacity, (b + 1) * RANK_BLOCK_WORDS);
+        for (int k = b * RANK_BLOCK_WORDS; k < end; k++) {
+            count += popCount(words[k]);
+        }
+        // block b holds the elements of rank [blockRank[b], count)
+        while (hint * SELECT_SAMPLE < count) {
+            selectHint[hint++] = b;
+        }
+    }
+    blockRank[blocks] = count;
+    rankDirty = false;
+}
+//Complexity: BC=WC=AC=theta(capacity)
+
+long long Set::rankBit(long long bit) const {
+    long long k = bit / WORD_BITS;
+    long long count = blockRank[k / RANK_BLOCK_WORDS];
+    for (long long j = k / RANK_BLOCK_WORDS * RANK_BLOCK_WORDS; j < k; j++) {
+        count += popCount(words[j]);
+    }
+    return count + popCount(words[k] & ~(ALL_ONES << (bit % WORD_BITS)));
+}
+//Complexity: BC=WC=AC=theta(RANK_BLOCK_WORDS)
+
+int Set::rank(TElem e) const {
+    if (length == 0 || e <= minElem)
+        return 0;
+    if (e > maxElem)
+        return length;
+    if (rankDirty)
+        buildRank();
+    return (int)rankBit(bitIndex(e));
+}
+//Complexity: BC=theta(1) WC=theta(capacity) AC=theta(RANK_BLOCK_WORDS) after the first query
+
+TElem Set::select(int k) const {
+    if (k < 0 || k >= length)
+        throw exception();
+    if (rankDirty)
+        buildRank();
+
+    // the sampled hints narrow the search to the blocks between two samples
+    int left = selectHint[k / SELECT_SAMPLE];
+    int right = k / SELECT_SAMPLE + 1 < (length + SELECT_SAMPLE - 1) / SELECT_SAMPLE
+        ? selectHint[k / SELECT_SAMPLE + 1] : (capacity + RANK_BLOCK_WORDS - 1) / RANK_BLOCK_WORDS - 1;
+    while (left < right) {
+        int middle = (left + right + 1) / 2;
+        if (blockRank[middle] <= k)
+            left = middle;
+        else
+            right = middle - 1;
+    }
+
+    int remaining = k - blockRank[left];
+    for (int j = left * RANK_BLOCK_WORDS; ; j++) {
+        int count = popCount(words[j]);
+        if (remaining < count) {
+            TWord word = words[j];
+            for (int i = 0; i < remaining; i++) {
+                word &= word - 1;
+            }
+            return (TElem)(base + (long long)j * WORD_BITS + countTrailingZeros(word));
+        }
+        remaining -= count;
+    }
+}
+//Complexity: BC=theta(1) WC=theta(capacity) AC=theta(log(blocks between samples) + RANK_BLOCK_WORDS) after the first query
+
+int Set::countInRange(TElem lo, TElem hi) const {
+    if (lo > hi)
+        throw exception();
+    int upper = hi >= maxElem ? length : rank(hi + 1);
+    return upper - rank(lo);
+}
+//Complexity: BC=theta(1) WC=theta(capacity) AC=theta(RANK_BLOCK_WORDS) after the first query
+
+bool Set::isSubsetOf(const Set& other) const {
+    if (length == 0)
+        return true;
+    if (length > other.length)
+        return false;
+
+    int first, last, offset;
+    if (!overlap(other, first, last, offset))
+        return false;
+    if (anyWords(words, first) || anyWords(words + last + 1, capacity - last - 1))
+        return false;
+    return !anyAndNotWords(words + first, other.words + first + offset, last - first + 1);
+}
+//Complexity: BC=theta(1) WC=AC=theta(capacity)
+
+bool Set::equals(const Set& other) const {
+    return length == other.length && isSubsetOf(other);
+}
+//Complexity: BC=theta(1) WC=AC=theta(capacity)
 
 int Set::size() const {
     return length;
@@ -89,12 +789,138 @@ bool Set::isEmpty() const {
 //Complexity: BC=WC=AC=theta(1)
 
 Set::~Set() {
-	delete[] elements;
+	detachSnapshot();
+	delete[] words;
+	freeSummary();
+	delete[] blockRank;
+	delete[] selectHint;
 }
 //Complexity: BC=WC=AC=theta(1)
 
+int Set::toArray(TElem* out) const {
+    if (length == 0)
+        return 0;
+    int first = (int)(bitIndex(minElem) / WORD_BITS);
+    int last = (int)(bitIndex(maxElem) / WORD_BITS);
+    if (last - first < length)
+        return decodeWords(words + first, last - first + 1, base + (long long)first * WORD_BITS, out);
+
+    // sparse set: the summary jumps over the empty words
+    int count = 0;
+    for (long long bit = nextBit(bitIndex(minElem)); bit >= 0; bit = nextBit((bit / WORD_BITS + 1) * WORD_BITS)) {
+        long long k = bit / WORD_BITS;
+        count += decodeWords(words + k, 1, base + k * WORD_BITS, out + count);
+    }
+    return count;
+}
+//Complexity: BC=WC=AC=theta(min((maxElem - minElem) / WORD_BITS, size * summaryLevels) + size)
+
+vector<TElem> Set::toVector() const {
+    vector<TElem> result(length);
+    toArray(result.data());
+    return result;
+}
+//Complexity: BC=WC=AC=theta(min((maxElem - minElem) / WORD_BITS, size * summaryLevels) + size)
+
+void Set::beforeWrite(long long first, long long last) {
+    if (savedPages.empty() || first > last)
+        return;
+    long long p = first / SNAPSHOT_PAGE_WORDS;
+    long long lastPage = last / SNAPSHOT_PAGE_WORDS;
+    while (p <= lastPage && savedPages[p]) {
+        p++;
+    }
+    if (p > lastPage)
+        return;
+
+    shared_ptr<SnapshotPages> pages = snapshotPages.lock();
+    if (!pages) {
+        // the snapshot was released, nothing has to be saved any more
+        savedPages.clear();
+        return;
+    }
+    lock_guard<mutex> guard(pages->lock);
+    for (; p <= lastPage; p++) {
+        if (!savedPages[p]) {
+            pages->save((int)p);
+            savedPages[p] = true;
+        }
+    }
+}
+//Complexity: BC=theta(1) WC=theta((last - first) + SNAPSHOT_PAGE_WORDS) AC=theta((last - first) / SNAPSHOT_PAGE_WORDS)
+
+void Set::detachSnapshot() {
+    shared_ptr<SnapshotPages> pages = snapshotPages.lock();
+    if (pages) {
+        lock_guard<mutex> guard(pages->lock);
+        for (int p = 0; p < (int)savedPages.size(); p++) {
+            if (!savedPages[p])
+                pages->save(p);
+        }
+        pages->live = nullptr;
+    }
+    snapshotPages.reset();
+    savedPages.clear();
+}
+//Complexity: BC=theta(1) WC=AC=theta(capacity)
+
+SetSnapshot Set::snapshot() {
+    // an older snapshot gets its own copy of the pages it still shares
+    detachSnapshot();
+    shared_ptr<SnapshotPages> pages = make_shared<SnapshotPages>(words, capacity);
+    snapshotPages = pages;
+    savedPages.assign(pages->saved.size(), false);
+    return SetSnapshot(pages, base, minElem, maxElem, length);
+}
+//Complexity: BC=WC=AC=theta(capacity / SNAPSHOT_PAGE_WORDS) if no older snapshot shares pages
+
 SetIterator Set::iterator() {
 	return SetIterator(*this);
 }
-//Complexity: BC=theta(1) WC=AC=theta(capacity)
+//Complexity: BC=theta(1) WC=AC=theta(summaryLevels)
+
+vector<SetIterator> Set::partitions(int k) {
+    if (k <= 0)
+        throw exception();
+
+    // partition i starts at the word holding the element of rank i * size() / k
+    vector<SetIterator> result;
+    TElem lower = INT_MIN;
+    for (int i = 1; i < k; i++) {
+        long long start = lower;
+        if (length > 0)
+            start = base + bitIndex(select((int)((long long)i * length / k))) / WORD_BITS * WORD_BITS;
+        if (start <= lower) {
+            // nothing is left between the previous bound and this one, the partition is empty
+            result.push_back(SetIterator(*this, 1, 0));
+            continue;
+        }
+        result.push_back(SetIterator(*this, lower, (TElem)(start - 1)));
+        lower = (TElem)start;
+    }
+    result.push_back(SetIterator(*this, lower, INT_MAX));
+    return result;
+}
+//Complexity: BC=WC=AC=theta(k * (log(blocks between samples) + RANK_BLOCK_WORDS + summaryLevels)) after the first query
+
+void Set::parallelForEach(const function<void(TElem)>& fn, int threads) {
+    vector<SetIterator> parts = partitions(threads);
+    auto consume = [&fn](SetIterator& it) {
+        while (it.valid()) {
+            fn(it.getCurrent());
+            it.next();
+        }
+    };
+
+    // the calling thread takes the last partition itself
+    vector<thread> workers;
+    for (int i = 0; i < threads - 1; i++) {
+        workers.push_back(thread(consume, ref(parts[i])));
+    }
+    consume(parts[threads - 1]);
+    for (thread& w : workers) {
+        w.join();
+    }
+}
+//Complexity: BC=WC=AC=theta(size / threads + (maxElem - minElem) / WORD_BITS / threads) per thread
 
@@ -6,42 +6,239 @@
 typedef int TElem;
 class SetIterator;
 
+#include "Bits.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct SnapshotPages;
+class SetSnapshot;
+
+// enough summary levels for a bitmap covering every value of TElem
+#define MAX_SUMMARY_LEVELS 5
+
+// words per block of the rank directory, and elements between two select hints
+#define RANK_BLOCK_WORDS 8
+#define SELECT_SAMPLE 4096
+
+// words per page shared between a Set and its snapshot
+#define SNAPSHOT_PAGE_WORDS 512
+
 class Set {
     // DO NOT CHANGE THIS PART
     friend class SetIterator;
 
 private:
     //  Internal Representation
-    bool* elements;  // dynamic array representing presence of elements
-    int minElem;     // minimum element stored
-    int maxElem;     // maximum element stored
-    int capacity;    // size of the dynamic array
+    TWord* words;    // bitmap, bit i of words[k] is set if base + k * WORD_BITS + i is in the set
+    int base;        // element represented by the first bit, always a multiple of WORD_BITS
+    int minElem;     // minimum element stored (the bitmap may extend beyond it)
+    int maxElem;     // maximum element stored (the bitmap may extend beyond it)
+    int capacity;    // number of words in the bitmap
     int length;      // number of elements in the set
 
+    // occupancy summary: bit k of summary[0] is set if words[k] != 0,
+    // bit k of summary[l] is set if summary[l - 1][k] != 0, the last level has a single word
+    TWord* summary[MAX_SUMMARY_LEVELS];
+    int summaryWords[MAX_SUMMARY_LEVELS]; // number of words of every summary level
+    int summaryLevels;                    // number of summary levels in use
+
+    // rank directory, rebuilt by the first rank query after a change
+    mutable int* blockRank;   // blockRank[b] = number of elements in the words before block b
+    mutable int* selectHint;  // selectHint[i] = block holding the element of rank i * SELECT_SAMPLE
+    mutable bool rankDirty;   // the directory is out of date
+
+    // pages of the bitmap shared with the last snapshot, saved there before they change
+    std::weak_ptr<SnapshotPages> snapshotPages;
+    std::vector<bool> savedPages; // savedPages[p] is true once page p was saved, empty without a snapshot
+
+    // position of e in the bitmap, counted in bits from base
+    long long bitIndex(TElem e) const;
+
+    // checks whether the bitmap already has room for every element of [lo, hi]
+    bool covers(TElem lo, TElem hi) const;
+
+    // grows the bitmap so that it covers [lo, hi]
+    // if geometric is true the capacity is at least doubled and the slack goes to the side that is growing
+    void grow(TElem lo, TElem hi, bool geometric);
+
+    // moves the bitmap into newCapacity words starting at element newBase
+    void resize(int newBase, int newCapacity);
+
+    // allocates the summary levels for the current capacity and fills them from the bitmap
+    void buildSummary();
+    void freeSummary();
+
+    // recomputes the summary bits of words [first, last] after they were changed in bulk
+    void refreshSummary(int first, int last);
+
+    // updates the summary after words[k] went from zero to non-zero or back
+    void markWord(int k);
+    void unmarkWord(int k);
+
+    // smallest set bit >= i / largest set bit <= i of a summary level, -1 if there is none
+    long long nextSummaryBit(int level, long long i) const;
+    long long prevSummaryBit(int level, long long i) const;
+
+    // smallest set bit >= from / largest set bit <= from of the bitmap, -1 if there is none
+    long long nextBit(long long from) const;
+    long long prevBit(long long from) const;
+
+    // sets / clears the bits [from, to] of the bitmap, whole words at a time
+    // returns the change in the number of set bits
+    long long setBits(long long from, long long to);
+    long long clearBits(long long from, long long to);
+
+    // saves the pages of words [first, last] to the snapshot before they are changed
+    void beforeWrite(long long first, long long last);
+
+    // saves every page that is still shared and stops sharing the bitmap with the snapshot
+    void detachSnapshot();
+
+    // fills the rank directory from the bitmap
+    void buildRank() const;
+
+    // number of set bits before bit of the bitmap
+    long long rankBit(long long bit) const;
+
+    // extends the logical range [minElem, maxElem] so that it contains [lo, hi]
+    void widen(TElem lo, TElem hi);
+
+    // moves minElem and maxElem back onto the smallest and largest element after removals
+    void tighten();
+
+    // releases the unused words once the elements fill less than a quarter of the bitmap
+    void compact();
+
+    // finds the words [first, last] of this bitmap that lie under the logical range of other
+    // word k of this bitmap holds the same elements as word k + offset of the bitmap of other
+    // returns false if there are no such words
+    bool overlap(const Set& other, int& first, int& last, int& offset) const;
+
 public:
     // implicit constructor
     Set();
 
+    // copy constructor, the copy gets its own bitmap
+    Set(const Set& other);
+
+    // assignment operator, the bitmap is copied
+    Set& operator=(const Set& other);
+
     // adds an element to the set
     // returns true if the element was added, false otherwise
     bool add(TElem e);
 
+    // makes room for every element of [lo, hi] with at most one reallocation
+    // throws an exception if lo > hi
+    void reserveRange(TElem lo, TElem hi);
+
+    // adds every element of [lo, hi] with at most one reallocation
+    // returns the number of elements that were not in the set before
+    // throws an exception if lo > hi
+    int addRange(TElem lo, TElem hi);
+
+    // adds the n elements of elems with at most one reallocation
+    // returns the number of elements that were not in the set before
+    int addAll(const TElem* elems, int n);
+
     // removes an element from the set
     // returns true if e was removed, false otherwise
+    // a removal may compact the bitmap, which invalidates the positions of all iterators on the set:
+    // they must be moved again with first() or seek() before they are used
     bool remove(TElem e);
 
+    // removes every element of [lo, hi]
+    // returns the number of elements that were removed
+    // invalidates the positions of the iterators on the set, like remove
+    // throws an exception if lo > hi
+    int removeRange(TElem lo, TElem hi);
+
+    // releases every word of the bitmap outside [minElem, maxElem]
+    void shrinkToFit();
+
     // checks whether an element belongs to the set or not
     bool search(TElem elem) const;
 
+    // checks a batch of elements at once: out[i] = 1 if keys[i] belongs to the set, 0 otherwise
+    void searchMany(const TElem* keys, int n, unsigned char* out) const;
+
+    // same as searchMany, with the result of keys[i] in bit i % 64 of out[i / 64]
+    // out must hold (n + 63) / 64 words
+    void searchManyMask(const TElem* keys, int n, TWord* out) const;
+
     // returns the number of elements
     int size() const;
 
     // check whether the set is empty or not
     bool isEmpty() const;
 
+    // returns the smallest element greater than e, NULL_TELEM if there is none
+    TElem successor(TElem e) const;
+
+    // returns the largest element smaller than e, NULL_TELEM if there is none
+    TElem predecessor(TElem e) const;
+
+    // returns the number of elements smaller than e
+    int rank(TElem e) const;
+
+    // returns the element with k smaller elements (the k-th smallest, counted from 0)
+    // throws an exception if k is not in [0, size())
+    TElem select(int k) const;
+
+    // returns the number of elements of [lo, hi]
+    // throws an exception if lo > hi
+    int countInRange(TElem lo, TElem hi) const;
+
+    // in-place set operations, the set becomes the result of the operation with other
+    // intersect, subtract and symmetricDifference invalidate the positions of the iterators on the set, like remove
+    void unite(const Set& other);
+    void intersect(const Set& other);
+    void subtract(const Set& other);
+    void symmetricDifference(const Set& other);
+
+    // out-of-place set operations, return a new set and leave a and b unchanged
+    static Set unite(const Set& a, const Set& b);
+    static Set intersect(const Set& a, const Set& b);
+    static Set subtract(const Set& a, const Set& b);
+    static Set symmetricDifference(const Set& a, const Set& b);
+
+    // checks whether every element of the set belongs to other
+    bool isSubsetOf(const Set& other) const;
+
+    // checks whether the set and other contain the same elements
+    bool equals(const Set& other) const;
+
+    // writes the elements in increasing order to out, which must hold size() elements
+    // returns the number of elements written
+    int toArray(TElem* out) const;
+
+    // returns the elements in increasing order
+    std::vector<TElem> toVector() const;
+
+    // returns a read-only view of the current elements
+    // the view stays the same while the set changes, only the pages changed after the call are copied
+    SetSnapshot snapshot();
+
+    // rebuilds a set from a file written by SetSnapshot::writeTo
+    // throws an exception if the file can not be read
+    static Set load(const std::string& path);
+
     // return an iterator for the set
     SetIterator iterator();
 
+    // splits the set into k iterators over consecutive, disjoint ranges of elements
+    // with about size() / k elements each; together they return every element once
+    // a removal through one of them invalidates the positions of the others, like remove
+    // throws an exception if k <= 0
+    std::vector<SetIterator> partitions(int k);
+
+    // calls fn once for every element, spread over the given number of threads
+    // fn is called from several threads at the same time and must not change the set
+    // throws an exception if threads <= 0
+    void parallelForEach(const std::function<void(TElem)>& fn, int threads);
+
     // destructor
     ~Set();
 };
@@ -2,42 +2,63 @@
 #include "Set.h"
 #include <stdexcept>
 #include <algorithm>
+#include <climits>
 
 using namespace std;
 
-SetIterator::SetIterator(Set& s) : set(s), index(0) {
+SetIterator::SetIterator(Set& s) : set(s), index(0), end(0), lower(INT_MIN), upper(INT_MAX) {
 	first();
 }
-//Complexity: BC=theta(1) WC=AC=theta(capacity)
+//Complexity: BC=theta(1) WC=AC=theta(summaryLevels)
+
+SetIterator::SetIterator(Set& s, TElem lower, TElem upper) : set(s), index(0), end(0), lower(lower), upper(upper) {
+	first();
+}
+//Complexity: BC=theta(1) WC=AC=theta(summaryLevels)
+
+void SetIterator::advance(long long from) {
+    if (from >= end) {
+        index = end;
+        return;
+    }
+
+    // the summary levels skip runs of empty words
+    long long bit = set.nextBit(from);
+    index = bit < 0 ? end : min(bit, end);
+}
+//Complexity: BC=theta(1) WC=AC=theta(summaryLevels)
 
 void SetIterator::first() {
-    index = 0;
-    while (index < set.capacity && !set.elements[index]) {
-        index++;
+    TElem from = max(lower, set.minElem);
+    TElem to = min(upper, set.maxElem);
+    if (from > to) {
+        // the set is empty, or has nothing inside the bounds
+        index = end = 0;
+        return;
     }
+    // only the words of [minElem, maxElem] are visited, not the slack around them
+    end = set.bitIndex(to) + 1;
+    advance(set.bitIndex(from));
 }
-//Complexity: BC=theta(1) WC=AC=theta(capacity)
+//Complexity: BC=theta(1) WC=AC=theta(summaryLevels)
 
 void SetIterator::next() {
     if (!valid())
         throw exception();
 
-    index++;
-    while (index < set.capacity && !set.elements[index]) {
-        index++;
-    }
+    advance(index + 1);
 }
-//Complexity: BC=theta(1) WC=AC=theta(capacity)
+//Complexity: BC=theta(1) WC=AC=theta(summaryLevels)
 
 TElem SetIterator::getCurrent() {
     if (!valid())
         throw exception();
-    return index + set.minElem;
+    return (TElem)(index + set.base);
 }
 //Complexity: BC=WC=AC=theta(1)
 
 bool SetIterator::valid() const {
-    return index < set.capacity;
+    return index < end;
 }
 //Complexity: BC=WC=AC=theta(1)
 
@@ -45,9 +66,20 @@ TElem SetIterator::remove() {
     if (!valid())
         throw exception();
     TElem current = getCurrent();
-    set.elements[index] = false;
-    set.length--;
-    next();
+    set.remove(current);
+
+    // removing may have compacted the bitmap, so the position is found again from the value
+    if (set.isEmpty() || current >= set.maxElem || current >= upper)
+        index = end;
+    else
+        seek(current + 1);
     return current;
 }
-//Complexity: BC=theta(1) WC=AC=theta(capacity)
\ No newline at end of file
+//Complexity: BC=theta(1) WC=AC=theta(summaryLevels)
+
+void SetIterator::seek(TElem e) {
+    first();
+    if (valid() && e > getCurrent())
+        advance(set.bitIndex(e));
+}
+//Complexity: BC=theta(1) WC=AC=theta(summaryLevels)
\ No newline at end of file
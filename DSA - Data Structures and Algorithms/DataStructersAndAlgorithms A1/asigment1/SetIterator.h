@@ -9,7 +9,14 @@ class SetIterator
 private:
 	Set& set; //reference to the container
 	SetIterator(Set& s); //private constructor of the iterator
-	int index; //index of the current element
+	SetIterator(Set& s, TElem lower, TElem upper); //iterator over the elements of [lower, upper] only
+	long long index; //bit index of the current element, counted from set.base
+	long long end; //bit index one past the last position that can hold an element
+	TElem lower; //smallest element the iterator can return
+	TElem upper; //largest element the iterator can return
+
+	//moves index to the first element stored at bit position from or later
+	void advance(long long from);
 
 
 public:
@@ -17,7 +24,12 @@ public:
 	void next();
 	TElem getCurrent();
 	bool valid() const;
+	//removes the current element and moves to the next one
+	//this iterator stays valid, the positions of the other iterators on the set are invalidated, like by Set::remove
 	TElem remove();
+
+	//moves the iterator to the smallest element >= e, invalid if there is none
+	void seek(TElem e);
 };
 
 
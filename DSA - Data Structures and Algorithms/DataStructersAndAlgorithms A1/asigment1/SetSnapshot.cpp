@@ -0,0 +1,136 @@
+#include "SetSnapshot.h"
+#include "WordKernels.h"
+#include <exception>
+#include <algorithm>
+#include <fstream>
+using namespace std;
+
+// marks the start of a snapshot file
+static const char SNAPSHOT_MAGIC[8] = { 'S', 'E', 'T', 'S', 'N', 'A', 'P', '1' };
+
+SnapshotPages::SnapshotPages(const TWord* live, int capacity) {
+    this->live = live;
+    this->capacity = capacity;
+    saved.assign((capacity + SNAPSHOT_PAGE_WORDS - 1) / SNAPSHOT_PAGE_WORDS, nullptr);
+}
+//Complexity: BC=WC=AC=theta(capacity / SNAPSHOT_PAGE_WORDS)
+
+void SnapshotPages::save(int p) {
+    if (saved[p] != nullptr)
+        return;
+    int first = p * SNAPSHOT_PAGE_WORDS;
+    int count = min(SNAPSHOT_PAGE_WORDS, capacity - first);
+    saved[p] = new TWord[count];
+    copy(live + first, live + first + count, saved[p]);
+}
+//Complexity: BC=theta(1) WC=AC=theta(SNAPSHOT_PAGE_WORDS)
+
+void SnapshotPages::read(long long first, int count, TWord* out) {
+    lock_guard<mutex> guard(lock);
+    while (count > 0) {
+        int p = (int)(first / SNAPSHOT_PAGE_WORDS);
+        int offset = (int)(first % SNAPSHOT_PAGE_WORDS);
+        int n = min(count, SNAPSHOT_PAGE_WORDS - offset);
+        const TWord* source = saved[p] != nullptr ? saved[p] + offset : live + first;
+        copy(source, source + n, out);
+        first += n;
+        out += n;
+        count -= n;
+    }
+}
+//Complexity: BC=WC=AC=theta(count)
+
+SnapshotPages::~SnapshotPages() {
+    for (TWord* page : saved) {
+        delete[] page;
+    }
+}
+//Complexity: BC=WC=AC=theta(capacity / SNAPSHOT_PAGE_WORDS)
+
+SetSnapshot::SetSnapshot(const shared_ptr<SnapshotPages>& pages, int base, int minElem, int maxElem, int length)
+    : pages(pages), base(base), minElem(minElem), maxElem(maxElem), length(length) {
+}
+//Complexity: BC=WC=AC=theta(1)
+
+bool SetSnapshot::search(TElem elem) const {
+    if (elem < minElem || elem > maxElem)
+        return false;
+    long long index = (long long)elem - base;
+    TWord word;
+    pages->read(index / WORD_BITS, 1, &word);
+    return (word >> (index % WORD_BITS)) & 1;
+}
+//Complexity: BC=WC=AC=theta(1)
+
+int SetSnapshot::size() const {
+    return length;
+}
+//Complexity: BC=WC=AC=theta(1)
+
+bool SetSnapshot::isEmpty() const {
+    return length == 0;
+}
+//Complexity: BC=WC=AC=theta(1)
+
+void SetSnapshot::writeTo(const string& path) const {
+    ofstream out(path, ios::binary);
+    if (!out)
+        throw exception();
+
+    // header: the logical range, the number of elements and the words covering the range
+    int first = 0;
+    int count = 0;
+    if (length > 0) {
+        first = (int)(((long long)minElem - base) / WORD_BITS);
+        count = (int)(((long long)maxElem - base) / WORD_BITS) - first + 1;
+    }
+    int header[4] = { minElem, maxElem, length, count };
+    out.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    out.write((const char*)header, sizeof(header));
+
+    // the pages are copied one at a time, so the set waits at most for one page
+    TWord buffer[SNAPSHOT_PAGE_WORDS];
+    for (int k = 0; k < count; ) {
+        int n = min(count - k, SNAPSHOT_PAGE_WORDS - (first + k) % SNAPSHOT_PAGE_WORDS);
+        pages->read(first + k, n, buffer);
+        out.write((const char*)buffer, n * sizeof(TWord));
+        k += n;
+    }
+    if (!out)
+        throw exception();
+}
+//Complexity: BC=WC=AC=theta((maxElem - minElem) / WORD_BITS)
+
+Set Set::load(const string& path) {
+    ifstream in(path, ios::binary);
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+    int header[4];
+    if (!in.read(magic, sizeof(magic)) || !equal(magic, magic + sizeof(magic), SNAPSHOT_MAGIC) ||
+        !in.read((char*)header, sizeof(header)))
+        throw exception();
+
+    Set result;
+    int minElem = header[0];
+    int maxElem = header[1];
+    int length = header[2];
+    int count = header[3];
+    if (length == 0)
+        return result;
+    if (minElem > maxElem || count != (int)(((long long)maxElem - (minElem & ~(WORD_BITS - 1))) / WORD_BITS + 1))
+        throw exception();
+
+    // the bitmap of the result starts at the same word boundary as the saved words
+    result.reserveRange(minElem, maxElem);
+    int first = (int)(result.bitIndex(minElem) / WORD_BITS);
+    if (!in.read((char*)(result.words + first), count * sizeof(TWord)))
+        throw exception();
+    // the header must agree with the words, otherwise size, rank and select would disagree with the bitmap
+    if (countWords(result.words + first, count) != length)
+        throw exception();
+    result.minElem = minElem;
+    result.maxElem = maxElem;
+    result.length = length;
+    result.refreshSummary(first, first + count - 1);
+    return result;
+}
+//Complexity: BC=WC=AC=theta((maxElem - minElem) / WORD_BITS)
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Set.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Pages of a bitmap shared between a Set and a snapshot of it.
+// A page stays in the set until the set is about to change it; the set then saves the old page here first.
+struct SnapshotPages {
+    std::mutex lock;            // taken to save a page and to read one that may still be in the set
+    const TWord* live;          // bitmap of the set, used for the pages that were not saved
+    int capacity;               // number of words of the bitmap when the snapshot was taken
+    std::vector<TWord*> saved;  // saved[p] = copy of page p, nullptr while the set still holds it
+
+    SnapshotPages(const TWord* live, int capacity);
+
+    // copies page p out of the set, the caller holds lock
+    void save(int p);
+
+    // copies count words starting at word first, as they were when the snapshot was taken
+    void read(long long first, int count, TWord* out);
+
+    ~SnapshotPages();
+};
+
+// Read-only view of a Set at the moment Set::snapshot was called.
+// The view shares the bitmap with the set and only the pages the set changes afterwards are copied,
+// so it can be read or written to a file from another thread while the set keeps changing.
+class SetSnapshot {
+    friend class Set;
+
+private:
+    std::shared_ptr<SnapshotPages> pages;
+    int base;     // element represented by the first bit
+    int minElem;  // minimum element of the set
+    int maxElem;  // maximum element of the set
+    int length;   // number of elements of the set
+
+    SetSnapshot(const std::shared_ptr<SnapshotPages>& pages, int base, int minElem, int maxElem, int length);
+
+public:
+    // checks whether an element belonged to the set or not
+    bool search(TElem elem) const;
+
+    // returns the number of elements
+    int size() const;
+
+    // check whether the set was empty or not
+    bool isEmpty() const;
+
+    // writes the elements to a file that Set::load reads back
+    // throws an exception if the file can not be written
+    void writeTo(const std::string& path) const;
+};
@@ -70,4 +70,16 @@ void testAll() {
     catch (std::exception&) {
         assert(true);
     }
+
+    // range and batch updates
+    Set s3;
+    assert(s3.addRange(1, 100) == 100);
+    assert(s3.addRange(50, 150) == 50);
+    assert(s3.size() == 150);
+    assert(s3.removeRange(10, 19) == 10);
+    assert(s3.search(15) == false);
+    assert(s3.search(20) == true);
+    TElem batch[] = { 0, 5, 15, 200, 5 };
+    assert(s3.addAll(batch, 5) == 3);
+    assert(s3.size() == 143);
 }
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "Set.h"
+#include <exception>
+#include <initializer_list>
+
+template <TElem Min, TElem Max>
+class StaticSetIterator;
+
+// Set whose elements are known at compile time to lie in [Min, Max].
+// The bitmap is stored inside the object, so the set never allocates and can be built as a constant:
+//     constexpr StaticSet<0, 1023> ports{ 80, 443, 8080 };
+template <TElem Min, TElem Max>
+class StaticSet {
+    static_assert(Min <= Max, "StaticSet needs Min <= Max");
+    friend class StaticSetIterator<Min, Max>;
+
+private:
+    static constexpr long long RANGE = (long long)Max - Min + 1;
+    static constexpr int WORDS = (int)((RANGE + WORD_BITS - 1) / WORD_BITS);
+
+    //  Internal Representation
+    TWord words[WORDS]; // bit i stands for the element Min + i
+    int length;         // number of elements in the set
+
+    // index of the first element at bit position from or later, RANGE if there is none
+    long long nextBit(long long from) const {
+        if (from >= RANGE)
+            return RANGE;
+        int k = (int)(from / WORD_BITS);
+        TWord word = words[k] & (ALL_ONES << (from % WORD_BITS));
+        while (word == 0) {
+            if (++k == WORDS)
+                return RANGE;
+            word = words[k];
+        }
+        return (long long)k * WORD_BITS + countTrailingZeros(word);
+    }
+    //Complexity: BC=theta(1) WC=AC=theta(WORDS)
+
+public:
+    // implicit constructor
+    constexpr StaticSet() : words{}, length(0) {}
+    //Complexity: BC=WC=AC=theta(WORDS)
+
+    // constructor from a list of elements, duplicates are added once
+    // throws an exception if an element is outside [Min, Max]
+    constexpr StaticSet(std::initializer_list<TElem> elems) : words{}, length(0) {
+        for (TElem e : elems) {
+            add(e);
+        }
+    }
+    //Complexity: BC=WC=AC=theta(WORDS + number of elems)
+
+    // adds an element to the set
+    // returns true if the element was added, false otherwise
+    // throws an exception if e is outside [Min, Max]
+    constexpr bool add(TElem e) {
+        if (e < Min || e > Max)
+            throw std::exception();
+        long long index = (long long)e - Min;
+        TWord mask = 1ULL << (index % WORD_BITS);
+        if (words[index / WORD_BITS] & mask)
+            return false; // already in set
+        words[index / WORD_BITS] |= mask;
+        length++;
+        return true;
+    }
+    //Complexity: BC=WC=AC=theta(1)
+
+    // removes an element from the set
+    // returns true if e was removed, false otherwise
+    constexpr bool remove(TElem elem) {
+        if (!search(elem))
+            return false;
+        long long index = (long long)elem - Min;
+        words[index / WORD_BITS] &= ~(1ULL << (index % WORD_BITS));
+        length--;
+        return true;
+    }
+    //Complexity: BC=WC=AC=theta(1)
+
+    // checks whether an element belongs to the set or not
+    constexpr bool search(TElem elem) const {
+        // elements outside the range read bit 0 of word 0 and mask it away, so there is no branch
+        unsigned long long index = (unsigned long long)((long long)elem - Min);
+        bool inside = index < (unsigned long long)RANGE;
+        index = inside ? index : 0;
+        return ((words[index / WORD_BITS] >> (index % WORD_BITS)) & (TWord)inside) != 0;
+    }
+    //Complexity: BC=WC=AC=theta(1)
+
+    // returns the number of elements
+    constexpr int size() const {
+        return length;
+    }
+    //Complexity: BC=WC=AC=theta(1)
+
+    // check whether the set is empty or not
+    constexpr bool isEmpty() const {
+        return length == 0;
+    }
+    //Complexity: BC=WC=AC=theta(1)
+
+    // return an iterator for the set
+    StaticSetIterator<Min, Max> iterator() {
+        return StaticSetIterator<Min, Max>(*this);
+    }
+    //Complexity: BC=theta(1) WC=AC=theta(WORDS)
+};
+
+// iterator with the same operations as SetIterator
+template <TElem Min, TElem Max>
+class StaticSetIterator {
+    friend class StaticSet<Min, Max>;
+
+private:
+    StaticSet<Min, Max>& set; //reference to the container
+    long long index; //bit index of the current element, RANGE when the iterator is invalid
+
+    StaticSetIterator(StaticSet<Min, Max>& s) : set(s), index(0) {
+        first();
+    }
+    //Complexity: BC=theta(1) WC=AC=theta(WORDS)
+
+public:
+    void first() {
+        index = set.nextBit(0);
+    }
+    //Complexity: BC=theta(1) WC=AC=theta(WORDS)
+
+    void next() {
+        if (!valid())
+            throw std::exception();
+        index = set.nextBit(index + 1);
+    }
+    //Complexity: BC=theta(1) WC=AC=theta(WORDS)
+
+    TElem getCurrent() {
+        if (!valid())
+            throw std::exception();
+        return (TElem)(index + Min);
+    }
+    //Complexity: BC=WC=AC=theta(1)
+
+    bool valid() const {
+        return index < StaticSet<Min, Max>::RANGE;
+    }
+    //Complexity: BC=WC=AC=theta(1)
+
+    TElem remove() {
+        TElem current = getCurrent();
+        set.remove(current);
+        index = set.nextBit(index + 1);
+        return current;
+    }
+    //Complexity: BC=theta(1) WC=AC=theta(WORDS)
+
+    //moves the iterator to the smallest element >= e, invalid if there is none
+    void seek(TElem e) {
+        if (e > Max)
+            index = StaticSet<Min, Max>::RANGE;
+        else
+            index = set.nextBit(e < Min ? 0 : (long long)e - Min);
+    }
+    //Complexity: BC=theta(1) WC=AC=theta(WORDS)
+};
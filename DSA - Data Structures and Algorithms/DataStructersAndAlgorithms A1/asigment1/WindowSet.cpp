@@ -0,0 +1,118 @@
+#include "WindowSet.h"
+#include "WordKernels.h"
+#include <exception>
+#include <algorithm>
+#include <climits>
+using namespace std;
+
+WindowSet::WindowSet(int width) {
+    if (width <= 0)
+        throw exception();
+    this->width = width;
+    // a window that does not start on a word boundary touches one word more
+    long long needed = ((long long)width + WORD_BITS - 1) / WORD_BITS + 1;
+    capacity = 1;
+    while (capacity < needed) {
+        capacity *= 2;
+    }
+    words = new TWord[capacity]{ 0 };
+    highest = -1;
+    length = 0;
+}
+//Complexity: BC=WC=AC=theta(width / WORD_BITS)
+
+long long WindowSet::offsetOf(TElem e) {
+    return (long long)e - INT_MIN;
+}
+//Complexity: BC=WC=AC=theta(1)
+
+long long WindowSet::lowest() const {
+    return max(0LL, highest - width + 1);
+}
+//Complexity: BC=WC=AC=theta(1)
+
+void WindowSet::expire(long long from, long long to) {
+    long long firstWord = from / WORD_BITS;
+    long long lastWord = to / WORD_BITS;
+    for (long long w = firstWord; w <= lastWord; w++) {
+        TWord mask = ALL_ONES;
+        if (w == firstWord)
+            mask &= ALL_ONES << (from % WORD_BITS);
+        if (w == lastWord)
+            mask &= ALL_ONES >> (WORD_BITS - 1 - to % WORD_BITS);
+        TWord& word = words[w & (capacity - 1)];
+        length -= popCount(word & mask);
+        word &= ~mask;
+    }
+}
+//Complexity: BC=WC=AC=theta((to - from) / WORD_BITS)
+
+bool WindowSet::add(TElem e) {
+    long long offset = offsetOf(e);
+    if (offset > highest) {
+        long long oldLowest = lowest();
+        long long oldHighest = highest;
+        highest = offset;
+        if (oldHighest >= 0) {
+            if (lowest() > oldHighest) {
+                // the window jumped past all the old elements
+                length += (int)clearWords(words, capacity);
+            }
+            else if (lowest() > oldLowest) {
+                expire(oldLowest, lowest() - 1);
+            }
+        }
+    }
+    else if (offset < lowest()) {
+        return false; // older than the window
+    }
+
+    TWord mask = 1ULL << (offset % WORD_BITS);
+    TWord& word = words[(offset / WORD_BITS) & (capacity - 1)];
+    if (word & mask)
+        return false; // already in set
+    word |= mask;
+    length++;
+    return true;
+}
+//Complexity: BC=theta(1) WC=theta(width / WORD_BITS) AC=theta(1) amortized for increasing keys
+
+bool WindowSet::remove(TElem elem) {
+    if (!search(elem))
+        return false;
+    long long offset = offsetOf(elem);
+    words[(offset / WORD_BITS) & (capacity - 1)] &= ~(1ULL << (offset % WORD_BITS));
+    length--;
+    return true;
+}
+//Complexity: BC=WC=AC=theta(1)
+
+bool WindowSet::search(TElem elem) const {
+    long long offset = offsetOf(elem);
+    if (offset > highest || offset < lowest())
+        return false;
+    return (words[(offset / WORD_BITS) & (capacity - 1)] >> (offset % WORD_BITS)) & 1;
+}
+//Complexity: BC=WC=AC=theta(1)
+
+int WindowSet::size() const {
+    return length;
+}
+//Complexity: BC=WC=AC=theta(1)
+
+bool WindowSet::isEmpty() const {
+    return length == 0;
+}
+//Complexity: BC=WC=AC=theta(1)
+
+TElem WindowSet::windowStart() const {
+    if (highest < 0)
+        return NULL_TELEM;
+    return (TElem)(lowest() + INT_MIN);
+}
+//Complexity: BC=WC=AC=theta(1)
+
+WindowSet::~WindowSet() {
+    delete[] words;
+}
+//Complexity: BC=WC=AC=theta(1)
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Set.h"
+
+// Set for keys that keep moving upward, such as sequence numbers or timestamps.
+// Only the last width values up to the largest key added are kept: [highest - width + 1, highest].
+// The bitmap is a ring of words, so a new largest key drops the expired words in place
+// and the memory used never changes after construction.
+class WindowSet {
+private:
+    //  Internal Representation
+    TWord* words;      // ring of words, word w of the value range is kept in words[w & (capacity - 1)]
+    int capacity;      // number of words, a power of two
+    int width;         // number of values inside the window
+    long long highest; // largest key added, as an offset from INT_MIN; -1 before the first add
+    int length;        // number of elements inside the window
+
+    // offset of e from INT_MIN, so that values and words are never negative
+    static long long offsetOf(TElem e);
+
+    // smallest offset inside the window
+    long long lowest() const;
+
+    // removes the elements with offsets in [from, to], which must fit in the ring
+    void expire(long long from, long long to);
+
+public:
+    // constructor for a window of width values
+    // throws an exception if width <= 0
+    WindowSet(int width);
+
+    WindowSet(const WindowSet&) = delete;
+    WindowSet& operator=(const WindowSet&) = delete;
+
+    // adds an element to the set, moving the window forward if e is the largest key so far
+    // returns true if the element was added, false if it was already in the set or is older than the window
+    bool add(TElem e);
+
+    // removes an element from the set
+    // returns true if e was removed, false otherwise
+    bool remove(TElem elem);
+
+    // checks whether an element belongs to the set or not
+    bool search(TElem elem) const;
+
+    // returns the number of elements inside the window
+    int size() const;
+
+    // check whether the set is empty or not
+    bool isEmpty() const;
+
+    // returns the smallest value inside the window, NULL_TELEM before the first add
+    TElem windowStart() const;
+
+    // destructor
+    ~WindowSet();
+};
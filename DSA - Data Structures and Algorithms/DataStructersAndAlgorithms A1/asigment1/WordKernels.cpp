@@ -0,0 +1,260 @@
+#include "WordKernels.h"
+
+#if defined(__AVX2__)
+#define USE_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define USE_SSE2
+#include <emmintrin.h>
+#endif
+
+// every operation exists for plain words and for the vector type of the instruction set in use
+struct OrOp {
+    static TWord apply(TWord a, TWord b) { return a | b; }
+#if defined(USE_AVX2)
+    static __m256i apply(__m256i a, __m256i b) { return _mm256_or_si256(a, b); }
+#elif defined(USE_SSE2)
+    static __m128i apply(__m128i a, __m128i b) { return _mm_or_si128(a, b); }
+#endif
+};
+
+struct AndOp {
+    static TWord apply(TWord a, TWord b) { return a & b; }
+#if defined(USE_AVX2)
+    static __m256i apply(__m256i a, __m256i b) { return _mm256_and_si256(a, b); }
+#elif defined(USE_SSE2)
+    static __m128i apply(__m128i a, __m128i b) { return _mm_and_si128(a, b); }
+#endif
+};
+
+struct AndNotOp {
+    static TWord apply(TWord a, TWord b) { return a & ~b; }
+#if defined(USE_AVX2)
+    static __m256i apply(__m256i a, __m256i b) { return _mm256_andnot_si256(b, a); }
+#elif defined(USE_SSE2)
+    static __m128i apply(__m128i a, __m128i b) { return _mm_andnot_si128(b, a); }
+#endif
+};
+
+struct XorOp {
+    static TWord apply(TWord a, TWord b) { return a ^ b; }
+#if defined(USE_AVX2)
+    static __m256i apply(__m256i a, __m256i b) { return _mm256_xor_si256(a, b); }
+#elif defined(USE_SSE2)
+    static __m128i apply(__m128i a, __m128i b) { return _mm_xor_si128(a, b); }
+#endif
+};
+
+#if defined(USE_AVX2)
+// number of set bits of every 64-bit lane, using a 4-bit lookup table
+static inline __m256i popCount256(__m256i v) {
+    const __m256i lookup = _mm256_setr_epi8(
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowMask = _mm256_set1_epi8(0x0f);
+    __m256i low = _mm256_and_si256(v, lowMask);
+    __m256i high = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask);
+    __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low), _mm256_shuffle_epi8(lookup, high));
+    return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+}
+//Complexity: BC=WC=AC=theta(1)
+#endif
+
+template <typename Op>
+static long long applyWords(TWord* dst, const TWord* src, int n) {
+    long long delta = 0;
+    int k = 0;
+#if defined(USE_AVX2)
+    __m256i sum = _mm256_setzero_si256();
+    for (; k + 4 <= n; k += 4) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(dst + k));
+        __m256i r = Op::apply(a, _mm256_loadu_si256((const __m256i*)(src + k)));
+        _mm256_storeu_si256((__m256i*)(dst + k), r);
+        sum = _mm256_add_epi64(sum, _mm256_sub_epi64(popCount256(r), popCount256(a)));
+    }
+    long long lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, sum);
+    delta = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(USE_SSE2)
+    for (; k + 2 <= n; k += 2) {
+        TWord before0 = dst[k];
+        TWord before1 = dst[k + 1];
+        __m128i r = Op::apply(_mm_loadu_si128((const __m128i*)(dst + k)), _mm_loadu_si128((const __m128i*)(src + k)));
+        _mm_storeu_si128((__m128i*)(dst + k), r);
+        delta += popCount(dst[k]) + popCount(dst[k + 1]) - popCount(before0) - popCount(before1);
+    }
+#endif
+    for (; k < n; k++) {
+        TWord before = dst[k];
+        dst[k] = Op::apply(before, src[k]);
+        delta += popCount(dst[k]) - popCount(before);
+    }
+    return delta;
+}
+//Complexity: BC=WC=AC=theta(n)
+
+long long orWords(TWord* dst, const TWord* src, int n) {
+    return applyWords<OrOp>(dst, src, n);
+}
+//Complexity: BC=WC=AC=theta(n)
+
+long long andWords(TWord* dst, const TWord* src, int n) {
+    return applyWords<AndOp>(dst, src, n);
+}
+//Complexity: BC=WC=AC=theta(n)
+
+long long andNotWords(TWord* dst, const TWord* src, int n) {
+    return applyWords<AndNotOp>(dst, src, n);
+}
+//Complexity: BC=WC=AC=theta(n)
+
+long long xorWords(TWord* dst, const TWord* src, int n) {
+    return applyWords<XorOp>(dst, src, n);
+}
+//Complexity: BC=WC=AC=theta(n)
+
+long long clearWords(TWord* dst, int n) {
+    long long delta = 0;
+    for (int k = 0; k < n; k++) {
+        delta -= popCount(dst[k]);
+        dst[k] = 0;
+    }
+    return delta;
+}
+//Complexity: BC=WC=AC=theta(n)
+
+long long countWords(const TWord* a, int n) {
+    long long count = 0;
+    int k = 0;
+#if defined(USE_AVX2)
+    __m256i sum = _mm256_setzero_si256();
+    for (; k + 4 <= n; k += 4) {
+        sum = _mm256_add_epi64(sum, popCount256(_mm256_loadu_si256((const __m256i*)(a + k))));
+    }
+    long long lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, sum);
+    count = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+    for (; k < n; k++) {
+        count += popCount(a[k]);
+    }
+    return count;
+}
+//Complexity: BC=WC=AC=theta(n)
+
+bool anyAndNotWords(const TWord* a, const TWord* b, int n) {
+    int k = 0;
+#if defined(USE_AVX2)
+    for (; k + 4 <= n; k += 4) {
+        __m256i r = _mm256_andnot_si256(_mm256_loadu_si256((const __m256i*)(b + k)), _mm256_loadu_si256((const __m256i*)(a + k)));
+        if (!_mm256_testz_si256(r, r))
+            return true;
+    }
+#elif defined(USE_SSE2)
+    for (; k + 2 <= n; k += 2) {
+        __m128i r = _mm_andnot_si128(_mm_loadu_si128((const __m128i*)(b + k)), _mm_loadu_si128((const __m128i*)(a + k)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(r, _mm_setzero_si128())) != 0xFFFF)
+            return true;
+    }
+#endif
+    for (; k < n; k++) {
+        if (a[k] & ~b[k])
+            return true;
+    }
+    return false;
+}
+//Complexity: BC=theta(1) WC=AC=theta(n)
+
+bool anyWords(const TWord* a, int n) {
+    for (int k = 0; k < n; k++) {
+        if (a[k] != 0)
+            return true;
+    }
+    return false;
+}
+//Complexity: BC=theta(1) WC=AC=theta(n)
+
+#if defined(USE_AVX2)
+// bits of the 8 keys at keys, as 32-bit lanes holding 0 or 1
+static inline __m256i testBits256(const TWord* words, long long base, int lo, int hi, const int* keys) {
+    __m256i k = _mm256_loadu_si256((const __m256i*)keys);
+    __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi32(_mm256_set1_epi32(lo), k), _mm256_cmpgt_epi32(k, _mm256_set1_epi32(hi)));
+    __m256i inside = _mm256_xor_si256(outside, _mm256_set1_epi32(-1));
+    // keys - base fits in 32 unsigned bits, the bitmap is read as 32-bit words
+    __m256i bit = _mm256_sub_epi32(k, _mm256_set1_epi32((int)base));
+    __m256i word = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), (const int*)words, _mm256_srli_epi32(bit, 5), inside, 4);
+    __m256i shifted = _mm256_srlv_epi32(word, _mm256_and_si256(bit, _mm256_set1_epi32(31)));
+    return _mm256_and_si256(shifted, _mm256_set1_epi32(1));
+}
+//Complexity: BC=WC=AC=theta(1)
+#endif
+
+// bit of one key, without a branch on the range check
+static inline TWord testBit(const TWord* words, long long base, int lo, int hi, int key) {
+    bool inside = (key >= lo) & (key <= hi);
+    long long bit = inside ? key - base : 0;
+    return (words[bit / WORD_BITS] >> (bit % WORD_BITS)) & (TWord)inside;
+}
+//Complexity: BC=WC=AC=theta(1)
+
+void testBits(const TWord* words, long long base, int lo, int hi, const int* keys, int n, unsigned char* out) {
+    int i = 0;
+#if defined(USE_AVX2)
+    for (; i + 8 <= n; i += 8) {
+        __m256i r = testBits256(words, base, lo, hi, keys + i);
+        __m128i halves = _mm_packs_epi32(_mm256_castsi256_si128(r), _mm256_extracti128_si256(r, 1));
+        _mm_storel_epi64((__m128i*)(out + i), _mm_packs_epi16(halves, halves));
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = (unsigned char)testBit(words, base, lo, hi, keys[i]);
+    }
+}
+//Complexity: BC=WC=AC=theta(n)
+
+void testBitsMask(const TWord* words, long long base, int lo, int hi, const int* keys, int n, TWord* out) {
+    for (int k = 0; k < (n + WORD_BITS - 1) / WORD_BITS; k++) {
+        out[k] = 0;
+    }
+    int i = 0;
+#if defined(USE_AVX2)
+    for (; i + 8 <= n; i += 8) {
+        __m256i r = testBits256(words, base, lo, hi, keys + i);
+        TWord bits = (TWord)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_slli_epi32(r, 31)));
+        out[i / WORD_BITS] |= bits << (i % WORD_BITS);
+    }
+#endif
+    for (; i + WORD_BITS <= n; i += WORD_BITS) {
+        TWord bits = 0;
+        for (int j = 0; j < WORD_BITS; j++) {
+            bits |= testBit(words, base, lo, hi, keys[i + j]) << j;
+        }
+        out[i / WORD_BITS] = bits;
+    }
+    for (; i < n; i++) {
+        out[i / WORD_BITS] |= testBit(words, base, lo, hi, keys[i]) << (i % WORD_BITS);
+    }
+}
+//Complexity: BC=WC=AC=theta(n)
+
+int decodeWords(const TWord* a, int n, long long first, int* out) {
+    int count = 0;
+    for (int k = 0; k < n; k++) {
+        TWord word = a[k];
+        int value = (int)(first + (long long)k * WORD_BITS);
+        if (word == ALL_ONES) {
+            // full words are common in dense sets and need no bit scanning
+            for (int j = 0; j < WORD_BITS; j++) {
+                out[count + j] = value + j;
+            }
+            count += WORD_BITS;
+            continue;
+        }
+        while (word != 0) {
+            out[count++] = value + countTrailingZeros(word);
+            word &= word - 1;
+        }
+    }
+    return count;
+}
+//Complexity: BC=WC=AC=theta(n + number of set bits)
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Bits.h"
+
+// Word-wide kernels over bitmaps of n words.
+// They use AVX2 or SSE2 when the compiler targets them and plain 64-bit words otherwise.
+// The kernels that change dst return the change in its number of set bits.
+
+// dst = dst | src
+long long orWords(TWord* dst, const TWord* src, int n);
+
+// dst = dst & src
+long long andWords(TWord* dst, const TWord* src, int n);
+
+// dst = dst & ~src
+long long andNotWords(TWord* dst, const TWord* src, int n);
+
+// dst = dst ^ src
+long long xorWords(TWord* dst, const TWord* src, int n);
+
+// dst = 0
+long long clearWords(TWord* dst, int n);
+
+// number of set bits of a
+long long countWords(const TWord* a, int n);
+
+// checks whether a has a bit that is not set in b
+bool anyAndNotWords(const TWord* a, const TWord* b, int n);
+
+// checks whether a has any bit set
+bool anyWords(const TWord* a, int n);
+
+// out[i] = 1 if keys[i] is in [lo, hi] and bit keys[i] - base of words is set, 0 otherwise
+// words must hold the bits of every element of [lo, hi]
+void testBits(const TWord* words, long long base, int lo, int hi, const int* keys, int n, unsigned char* out);
+
+// same test, with the result of keys[i] stored in bit i % WORD_BITS of out[i / WORD_BITS]
+void testBitsMask(const TWord* words, long long base, int lo, int hi, const int* keys, int n, TWord* out);
+
+// writes first + i for every set bit i of a, in increasing order, to out
+// returns the number of values written
+int decodeWords(const TWord* a, int n, long long first, int* out);
@@ -3,12 +3,16 @@
 #include <iostream>
 #include "ShortTest.h"
 #include "ExtendedTest.h"
+#include "Benchmark.h"
 
 using namespace std;
 
 int main() {
 	testAll();
 	testAllExtended();
+#ifdef RUN_BENCHMARKS
+	benchmarkAll();
+#endif
 	
 	cout << "Test over" << endl;
 	system("pause");
@@ -0,0 +1,384 @@
+#include "Benchmark.h"
+#include "SortedBag.h"
+#include "SortedBagIterator.h"
+#include "UnrolledSortedBag.h"
+#include "UnrolledSortedBagIterator.h"
+#include <chrono>
+#include <iostream>
+
+using namespace std;
+using namespace std::chrono;
+
+static bool ascending(TComp e1, TComp e2) {
+	return e1 <= e2;
+}
+
+static double elapsedMs(steady_clock::time_point start) {
+	return duration<double, milli>(steady_clock::now() - start).count();
+}
+
+// the previous representation of SortedBag, a sorted doubly linked list searched from head
+struct ListBag {
+	struct Node {
+		TComp value;
+		int frequency;
+		Node* next;
+		Node* prev;
+	};
+	Node* head = nullptr;
+
+	void add(TComp e) {
+		Node* previous = nullptr;
+		Node* current = head;
+		while (current != nullptr && current->value != e && ascending(current->value, e)) {
+			previous = current;
+			current = current->next;
+		}
+		if (current != nullptr && current->value == e) {
+			current->frequency++;
+			return;
+		}
+		Node* node = new Node{ e, 1, current, previous };
+		if (current != nullptr)
+			current->prev = node;
+		if (previous != nullptr)
+			previous->next = node;
+		else
+			head = node;
+	}
+
+	int nrOccurrences(TComp e) const {
+		for (Node* current = head; current != nullptr; current = current->next) {
+			if (current->value == e)
+				return current->frequency;
+		}
+		return 0;
+	}
+
+	~ListBag() {
+		while (head != nullptr) {
+			Node* next = head->next;
+			delete head;
+			head = next;
+		}
+	}
+};
+
+// pseudo-random values in [0, range)
+static TComp nextValue(unsigned int& seed, int range) {
+	seed = seed * 1103515245u + 12345u;
+	return (TComp)((seed >> 8) % range);
+}
+
+void benchmarkSkipList() {
+	cout << "Benchmark skip list" << endl;
+	const int operations = 200000;
+
+	for (int distinct = 4; distinct <= 16384; distinct *= 4) {
+		unsigned int seed = 1;
+		long long sumList = 0;
+		auto start = steady_clock::now();
+		{
+			ListBag list;
+			for (int i = 0; i < operations; i++) {
+				list.add(nextValue(seed, distinct));
+				sumList += list.nrOccurrences(nextValue(seed, distinct));
+			}
+		}
+		double listNs = elapsedMs(start) * 1e6 / operations;
+
+		seed = 1;
+		long long sumSkip = 0;
+		start = steady_clock::now();
+		{
+			SortedBag bag(ascending);
+			for (int i = 0; i < operations; i++) {
+				bag.add(nextValue(seed, distinct));
+				sumSkip += bag.nrOccurrences(nextValue(seed, distinct));
+			}
+		}
+		double skipNs = elapsedMs(start) * 1e6 / operations;
+
+		cout << distinct << " distinct values: list " << listNs << " ns | skip list " << skipNs << " ns per add + nrOccurrences"
+			<< (listNs < skipNs ? " (list faster)" : "") << (sumList == sumSkip ? "" : " (MISMATCH)") << endl;
+	}
+}
+
+void benchmarkSlabs() {
+	cout << "Benchmark slabs" << endl;
+	const int sizes[] = { 1000000, 4000000 };
+
+	for (int distinct : sizes) {
+		// one new and one delete for every node, as the nodes were allocated before
+		long long nodeAllocations = 0;
+		auto start = steady_clock::now();
+		ListBag::Node* first = nullptr;
+		for (int i = distinct - 1; i >= 0; i--) {
+			first = new ListBag::Node{ i, 1, first, nullptr };
+			nodeAllocations++;
+		}
+		double nodeBuildMs = elapsedMs(start);
+		start = steady_clock::now();
+		while (first != nullptr) {
+			ListBag::Node* next = first->next;
+			delete first;
+			first = next;
+		}
+		double nodeTeardownMs = elapsedMs(start);
+
+		SortedBag bag(ascending);
+		start = steady_clock::now();
+		for (int i = 0; i < distinct; i++) {
+			bag.add(i);
+		}
+		double bagBuildMs = elapsedMs(start);
+		long long bagAllocations = bag.slabCount();
+		start = steady_clock::now();
+		bag.empty();
+		double bagTeardownMs = elapsedMs(start);
+
+		cout << distinct << " distinct values: new per node " << nodeAllocations << " allocations, teardown "
+			<< nodeTeardownMs << " ms (build " << nodeBuildMs << " ms without ordering)"
+			<< " | slabs " << bagAllocations << " allocations, teardown " << bagTeardownMs << " ms (build " << bagBuildMs << " ms)" << endl;
+	}
+}
+
+void benchmarkFinger() {
+	cout << "Benchmark finger" << endl;
+	const int n = 2000000;
+	const char* names[] = { "sorted", "nearly sorted", "random" };
+
+	for (int kind = 0; kind < 3; kind++) {
+		unsigned int seed = 7;
+		SortedBag bag(ascending);
+		auto start = steady_clock::now();
+		for (int i = 0; i < n; i++) {
+			TComp e = i;
+			if (kind == 1 && nextValue(seed, 10) == 0)
+				e = i - nextValue(seed, 5); // one value in ten arrives a little late
+			else if (kind == 2)
+				e = nextValue(seed, n);
+			bag.add(e);
+		}
+		double addNs = elapsedMs(start) * 1e6 / n;
+		cout << names[kind] << " input: " << addNs << " ns per add" << (bag.size() == n ? "" : " (MISMATCH)") << endl;
+	}
+}
+
+void benchmarkAddAll() {
+	cout << "Benchmark add all" << endl;
+	const int n = 2000000;
+	TComp* elems = new TComp[n];
+	unsigned int seed = 11;
+	for (int i = 0; i < n; i++) {
+		elems[i] = nextValue(seed, n / 4); // every value about four times
+	}
+
+	SortedBag one(ascending);
+	auto start = steady_clock::now();
+	for (int i = 0; i < n; i++) {
+		one.add(elems[i]);
+	}
+	double addMs = elapsedMs(start);
+
+	SortedBag bulk(ascending);
+	start = steady_clock::now();
+	bulk.addAll(elems, n / 2);
+	bulk.addAll(elems + n / 2, n - n / 2); // the second half is merged into the first one
+	double addAllMs = elapsedMs(start);
+
+	cout << "add: " << addMs << " ms, addAll: " << addAllMs << " ms"
+		<< (one.size() == bulk.size() && bulk.nrOccurrences(elems[0]) == one.nrOccurrences(elems[0]) ? "" : " (MISMATCH)") << endl;
+	delete[] elems;
+}
+
+void benchmarkSetOperations() {
+	cout << "Benchmark set operations" << endl;
+	const int n = 20000;
+	SortedBag a(ascending);
+	SortedBag b(ascending);
+	unsigned int seed = 13;
+	for (int i = 0; i < n; i++) {
+		a.add(nextValue(seed, n));
+		b.add(nextValue(seed, n));
+	}
+
+	// union through the public interface: every value of b is counted and added again
+	SortedBag slow(ascending);
+	slow.sumWith(a);
+	auto start = steady_clock::now();
+	SortedBagIterator it = b.iterator();
+	while (it.valid()) {
+		TComp e = it.getCurrent();
+		int missing = b.nrOccurrences(e) - slow.nrOccurrences(e);
+		for (int i = 0; i < missing; i++) {
+			slow.add(e);
+		}
+		it.next();
+	}
+	double slowMs = elapsedMs(start);
+
+	SortedBag fast(ascending);
+	fast.sumWith(a);
+	start = steady_clock::now();
+	fast.unionWith(b);
+	double fastMs = elapsedMs(start);
+
+	cout << "union by add: " << slowMs << " ms, unionWith: " << fastMs << " ms"
+		<< (slow.size() == fast.size() ? "" : " (MISMATCH)") << endl;
+}
+
+void benchmarkErase() {
+	cout << "Benchmark erase" << endl;
+	const int n = 1000000;
+	SortedBag byRemove(ascending);
+	SortedBag byErase(ascending);
+	TComp* elems = new TComp[n];
+	unsigned int seed = 17;
+	for (int i = 0; i < n; i++) {
+		elems[i] = nextValue(seed, n);
+	}
+	byRemove.addAll(elems, n);
+	byErase.addAll(elems, n);
+	delete[] elems;
+
+	// filter pass deleting the odd values, first by value, then through the iterator
+	auto start = steady_clock::now();
+	SortedBagIterator it = byRemove.iterator();
+	while (it.valid()) {
+		TComp e = it.getCurrent();
+		while (it.valid() && it.getCurrent() == e) {
+			it.next();
+		}
+		if (e % 2 != 0)
+			while (byRemove.remove(e)) {
+			}
+	}
+	double removeMs = elapsedMs(start);
+
+	start = steady_clock::now();
+	SortedBagIterator filter = byErase.iterator();
+	while (filter.valid()) {
+		if (filter.getCurrent() % 2 != 0)
+			filter.eraseAll();
+		else
+			filter.next();
+	}
+	double eraseMs = elapsedMs(start);
+
+	cout << "remove: " << removeMs << " ms, erase: " << eraseMs << " ms"
+		<< (byRemove.size() == byErase.size() ? "" : " (MISMATCH)") << endl;
+}
+
+void benchmarkUnrolled() {
+	cout << "Benchmark unrolled" << endl;
+	const int n = 100000;
+	const int rounds = 20;
+	SortedBag nodes(ascending);
+	UnrolledSortedBag blocks(ascending);
+	unsigned int seed = 19;
+	for (int i = 0; i < n; i++) {
+		TComp e = nextValue(seed, 4 * n);
+		nodes.add(e);
+		blocks.add(e);
+	}
+
+	long long sum = 0;
+	auto start = steady_clock::now();
+	for (int round = 0; round < rounds; round++) {
+		SortedBagIterator it = nodes.iterator();
+		while (it.valid()) {
+			sum += it.getCurrent();
+			it.next();
+		}
+	}
+	double nodesMs = elapsedMs(start);
+
+	start = steady_clock::now();
+	for (int round = 0; round < rounds; round++) {
+		UnrolledSortedBagIterator it = blocks.iterator();
+		while (it.valid()) {
+			sum -= it.getCurrent();
+			it.next();
+		}
+	}
+	double blocksMs = elapsedMs(start);
+
+	cout << "traversal: node per value " << nodesMs / rounds << " ms, blocks " << blocksMs / rounds << " ms"
+		<< (sum == 0 ? "" : " (MISMATCH)") << endl;
+}
+
+void benchmarkStaging() {
+	cout << "Benchmark staging" << endl;
+	const int n = 2000000;
+	const int reads = 100000;
+
+	for (int staging = 0; staging < 2; staging++) {
+		unsigned int seed = 23;
+		SortedBag bag(ascending);
+		bag.setStaging(staging == 1);
+		auto start = steady_clock::now();
+		for (int i = 0; i < n; i++) {
+			bag.add(nextValue(seed, n));
+		}
+		double addMs = elapsedMs(start);
+
+		start = steady_clock::now();
+		long long found = 0;
+		for (int i = 0; i < reads; i++) {
+			found += bag.nrOccurrences(nextValue(seed, n));
+		}
+		double readMs = elapsedMs(start);
+		cout << (staging == 1 ? "staged" : "direct") << ": " << addMs << " ms for the adds, " << readMs << " ms for the reads"
+			<< (bag.size() == n && found > 0 ? "" : " (MISMATCH)") << endl;
+	}
+}
+
+void benchmarkFilter() {
+	cout << "Benchmark filter" << endl;
+	const int n = 1000000;
+	const int lookups = 2000000;
+	const int hitPercents[] = { 1, 10, 50 };
+	TComp* elems = new TComp[n];
+	for (int i = 0; i < n; i++) {
+		elems[i] = 2 * i; // only even values are in the bag
+	}
+	SortedBag bag(ascending);
+	bag.addAll(elems, n);
+	delete[] elems;
+
+	for (int h = 0; h < 3; h++) {
+		double ms[2];
+		long long found[2];
+		for (int filtering = 0; filtering < 2; filtering++) {
+			bag.setFilter(filtering == 1);
+			unsigned int seed = 29;
+			found[filtering] = 0;
+			auto start = steady_clock::now();
+			for (int i = 0; i < lookups; i++) {
+				TComp e = 2 * nextValue(seed, n);
+				if (nextValue(seed, 100) >= hitPercents[h])
+					e++; // odd values miss
+				found[filtering] += bag.search(e) ? 1 : 0;
+			}
+			ms[filtering] = elapsedMs(start);
+		}
+		long long checked, rejected, falsePositives;
+		bag.filterStatistics(checked, rejected, falsePositives);
+		cout << hitPercents[h] << "% hits: " << ms[0] * 1e6 / lookups << " ns per search, " << ms[1] * 1e6 / lookups
+			<< " ns with the filter, false positive rate " << 100.0 * falsePositives / (rejected + falsePositives) << "%"
+			<< (found[0] == found[1] ? "" : " (MISMATCH)") << endl;
+	}
+}
+
+void benchmarkAll() {
+	benchmarkSkipList();
+	benchmarkSlabs();
+	benchmarkFinger();
+	benchmarkAddAll();
+	benchmarkSetOperations();
+	benchmarkErase();
+	benchmarkUnrolled();
+	benchmarkStaging();
+	benchmarkFilter();
+}
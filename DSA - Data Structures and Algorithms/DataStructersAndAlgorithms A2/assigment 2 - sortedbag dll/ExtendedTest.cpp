@@ -1,6 +1,8 @@
 #include "ShortTest.h"
 #include "SortedBag.h"
 #include "SortedBagIterator.h"
+#include "UnrolledSortedBag.h"
+#include "UnrolledSortedBagIterator.h"
 #include <assert.h>
 #include <iostream>
 #include <exception>
@@ -293,7 +295,455 @@ void testIterator(Relation rel) {
 	assert(count == sb.size());
 }
 
+void testSkipList(Relation r) {
+	cout << "Test skip list" << endl;
+	SortedBag sb(r);
+	for (int i = 0; i < 20000; i++) { //many distinct values, added out of order
+		sb.add((i * 7919) % 20000 - 10000);
+	}
+	for (int i = -10000; i < 10000; i = i + 2) {
+		sb.add(i);
+	}
+	assert(sb.size() == 30000);
+	for (int i = -10000; i < 10000; i++) {
+		assert(sb.nrOccurrences(i) == (i % 2 == 0 ? 2 : 1));
+	}
+	assert(sb.search(10000) == false);
+	for (int i = -10000; i < 10000; i = i + 3) { //removing whole nodes keeps the levels consistent
+		assert(sb.remove(i) == true);
+		if (i % 2 == 0)
+			assert(sb.remove(i) == true);
+		assert(sb.search(i) == false);
+	}
+	testIterator(sb, r);
+	sb.empty();
+	assert(sb.search(0) == false);
+	sb.add(5);
+	assert(sb.nrOccurrences(5) == 1);
+}
 
+void testHint(Relation r) {
+	cout << "Test hint" << endl;
+	SortedBag sb(r);
+	for (int i = 0; i < 10000; i++) { //sorted input
+		sb.add(i);
+	}
+	for (int i = 9999; i >= 0; i--) { //reverse sorted input
+		sb.add(i);
+	}
+	for (int i = 0; i < 10000; i = i + 2) { //nearly sorted input, neighbours swapped
+		sb.add(i + 1);
+		sb.add(i);
+	}
+	assert(sb.size() == 30000);
+	for (int i = 0; i < 10000; i++) {
+		assert(sb.nrOccurrences(i) == 3);
+	}
+	testIterator(sb, r);
+
+	SortedBagIterator it = sb.iterator();
+	sb.add(-5, it); //hint after the position of the element
+	sb.add(20000, it); //hint far from the position of the element
+	it.next();
+	it.next();
+	it.next();
+	sb.add(1, it);
+	assert(sb.nrOccurrences(1) == 4);
+	assert(sb.nrOccurrences(-5) == 1);
+	assert(sb.nrOccurrences(20000) == 1);
+	for (int i = 0; i < 10000; i = i + 5) { //removing the node the finger points to
+		assert(sb.remove(i) == true);
+		sb.add(i);
+		assert(sb.remove(i) == true);
+		assert(sb.remove(i) == true);
+		assert(sb.remove(i) == true);
+		assert(sb.search(i) == false);
+	}
+	sb.add(0);
+	assert(sb.nrOccurrences(0) == 1);
+	testIterator(sb, r);
+
+	SortedBag other(r);
+	other.add(1);
+	SortedBagIterator otherIt = other.iterator();
+	int size = sb.size();
+	try {
+		sb.add(2, otherIt); //a hint from another bag is rejected
+		assert(false);
+	}
+	catch (exception&) {
+		assert(true);
+	}
+	assert(sb.size() == size);
+	assert(other.size() == 1);
+	assert(other.nrOccurrences(2) == 0);
+}
+
+void testAddAll(Relation r) {
+	cout << "Test add all" << endl;
+	SortedBag sb(r);
+	sb.addAll(nullptr, 0);
+	assert(sb.isEmpty() == true);
+	TComp elems[20000];
+	for (int i = 0; i < 20000; i++) { //every value of [-5000, 5000) twice, out of order
+		elems[i] = (i * 7919) % 10000 - 5000;
+	}
+	sb.addAll(elems, 20000);
+	assert(sb.size() == 20000);
+	for (int i = -5000; i < 5000; i++) {
+		assert(sb.nrOccurrences(i) == 2);
+	}
+	testIterator(sb, r);
+	for (int i = 0; i < 20000; i++) { //merged into a bag that already has elements, some of them new
+		elems[i] = i - 10000;
+	}
+	sb.addAll(elems, 20000);
+	assert(sb.size() == 40000);
+	for (int i = -10000; i < 10000; i++) {
+		assert(sb.nrOccurrences(i) == (i >= -5000 && i < 5000 ? 3 : 1));
+	}
+	testIterator(sb, r);
+	for (int i = -10000; i < 10000; i = i + 4) { //the levels are consistent after the merge
+		assert(sb.remove(i) == true);
+		sb.add(i + 1);
+	}
+	assert(sb.size() == 40000);
+	assert(sb.search(-10000) == false);
+	assert(sb.nrOccurrences(-9999) == 2);
+	testIterator(sb, r);
+}
+void testSetOperations(Relation r) {
+	cout << "Test set operations" << endl;
+	SortedBag a(r);
+	SortedBag b(r);
+	for (int i = 0; i < 3000; i++) { //i occurs i % 4 times in a and i % 3 times in b
+		for (int j = 0; j < i % 4; j++) {
+			a.add(i);
+		}
+		for (int j = 0; j < i % 3; j++) {
+			b.add(i);
+		}
+	}
+	int sizeA = a.size();
+	int sizeB = b.size();
+
+	SortedBag c(r);
+	c.sumWith(a);
+	c.unionWith(b);
+	for (int i = 0; i < 3000; i++) {
+		assert(c.nrOccurrences(i) == (i % 4 > i % 3 ? i % 4 : i % 3));
+	}
+	testIterator(c, r);
+	c.intersectWith(a);
+	assert(c.size() == sizeA);
+	for (int i = 0; i < 3000; i++) {
+		assert(c.nrOccurrences(i) == i % 4);
+	}
+	c.intersectWith(b);
+	for (int i = 0; i < 3000; i++) {
+		assert(c.nrOccurrences(i) == (i % 4 < i % 3 ? i % 4 : i % 3));
+	}
+	assert(c.search(3) == false);
+	testIterator(c, r);
+	c.sumWith(a);
+	c.sumWith(b);
+	for (int i = 0; i < 3000; i++) {
+		assert(c.nrOccurrences(i) == (i % 4 < i % 3 ? i % 4 : i % 3) + i % 4 + i % 3);
+	}
+	c.subtract(a);
+	c.subtract(a);
+	for (int i = 0; i < 3000; i++) {
+		int expected = (i % 4 < i % 3 ? i % 4 : i % 3) + i % 3 - i % 4;
+		assert(c.nrOccurrences(i) == (expected > 0 ? expected : 0));
+	}
+	testIterator(c, r);
+	for (int i = 0; i < 3000; i = i + 7) { //the levels are consistent after the merges
+		c.add(i);
+		assert(c.remove(i) == true);
+	}
+	testIterator(c, r);
+
+	a.sumWith(a); //every operation also works with the bag itself
+	assert(a.size() == 2 * sizeA);
+	a.unionWith(a);
+	a.intersectWith(a);
+	assert(a.nrOccurrences(3) == 6);
+	a.subtract(a);
+	assert(a.isEmpty() == true);
+	a.add(1);
+	assert(a.size() == 1);
+	b.subtract(a);
+	assert(b.size() == sizeB - 1);
+
+	SortedBag other(r == relation2 ? relation3 : relation2);
+	try {
+		b.unionWith(other);
+		assert(false);
+	}
+	catch (exception&) {
+		assert(true);
+	}
+}
+void testErase(Relation r) {
+	cout << "Test erase" << endl;
+	SortedBag sb(r);
+	for (int i = 0; i < 1000; i++) { //i occurs i % 3 + 1 times
+		for (int j = 0; j <= i % 3; j++) {
+			sb.add(i);
+		}
+	}
+	assert(sb.size() == 1999);
+	SortedBagIterator it = sb.iterator();
+	while (it.valid()) { //filter pass: every multiple of 5 is removed, one occurrence of the other values is removed
+		TComp e = it.getCurrent();
+		if (e % 5 == 0) {
+			assert(it.eraseAll() == e % 3 + 1);
+		}
+		else {
+			it.erase();
+			while (it.valid() && it.getCurrent() == e) {
+				it.next();
+			}
+		}
+	}
+	int expected = 0;
+	for (int i = 0; i < 1000; i++) {
+		assert(sb.nrOccurrences(i) == (i % 5 == 0 ? 0 : i % 3));
+		expected += sb.nrOccurrences(i);
+	}
+	assert(sb.size() == expected);
+	testIterator(sb, r);
+	try {
+		it.erase();
+		assert(false);
+	}
+	catch (exception&) {
+		assert(true);
+	}
+
+	it.first();
+	TComp e = it.getCurrent();
+	int count = sb.nrOccurrences(e);
+	sb.add(e);
+	sb.add(e);
+	it.next();
+	assert(it.removeOccurences(count + 5, e) == count + 1); //only the occurrences from the current one on are removed
+	assert(sb.nrOccurrences(e) == 1);
+	assert(it.removeOccurences(1, e) == 0);
+	it.first();
+	assert(it.removeOccurences(5, e) == 1);
+	assert(sb.search(e) == false);
+
+	SortedBagIterator begin = sb.iterator();
+	SortedBagIterator end = sb.iterator();
+	for (int i = 0; i < 100; i++) {
+		end.next();
+		if (i % 2 == 0)
+			begin.next();
+	}
+	int size = sb.size();
+	assert(sb.eraseRange(begin, end) == 50);
+	assert(sb.size() == size - 50);
+	assert(begin.valid() == true);
+	testIterator(sb, r);
+	SortedBagIterator last = sb.iterator();
+	while (last.valid()) {
+		last.next();
+	}
+	assert(sb.eraseRange(begin, last) == size - 100);
+	assert(begin.valid() == false);
+	assert(sb.size() == 50);
+	testIterator(sb, r);
+	begin.first();
+	assert(sb.eraseRange(begin, last) == 50);
+	assert(sb.isEmpty() == true);
+	sb.add(7);
+	assert(sb.size() == 1);
+
+	SortedBag other(r);
+	try {
+		sb.eraseRange(begin, other.iterator());
+		assert(false);
+	}
+	catch (exception&) {
+		assert(true);
+	}
+
+	SortedBag staged(r); //a rejected call leaves the staged elements alone
+	staged.setStaging(true);
+	staged.add(3);
+	SortedBagIterator otherBegin = other.iterator();
+	try {
+		staged.eraseRange(otherBegin, other.iterator());
+		assert(false);
+	}
+	catch (exception&) {
+		assert(true);
+	}
+	assert(staged.slabCount() == 0);
+	assert(staged.size() == 1);
+}
+void testUnrolled(Relation r) {
+	cout << "Test unrolled" << endl;
+	UnrolledSortedBag sb(r);
+	assert(sb.isEmpty() == true);
+	assert(sb.remove(0) == false);
+	for (int i = 0; i < 20000; i++) { //many distinct values, added out of order, splitting the blocks
+		sb.add((i * 7919) % 20000 - 10000);
+	}
+	for (int i = -10000; i < 10000; i = i + 2) {
+		sb.add(i);
+	}
+	assert(sb.size() == 30000);
+	for (int i = -10000; i < 10000; i++) {
+		assert(sb.nrOccurrences(i) == (i % 2 == 0 ? 2 : 1));
+	}
+	assert(sb.search(10000) == false);
+	for (int i = -10000; i < 10000; i = i + 3) { //removing whole values merges the blocks
+		assert(sb.remove(i) == true);
+		if (i % 2 == 0)
+			assert(sb.remove(i) == true);
+		assert(sb.search(i) == false);
+	}
+	UnrolledSortedBagIterator it = sb.iterator();
+	TComp previous = it.getCurrent();
+	int count = 0;
+	while (it.valid()) {
+		assert(r(previous, it.getCurrent()));
+		previous = it.getCurrent();
+		it.next();
+		count++;
+	}
+	assert(count == sb.size());
+	try {
+		it.next();
+		assert(false);
+	}
+	catch (exception&) {
+		assert(true);
+	}
+	for (int i = -10000; i < 10000; i++) { //removing everything frees all the blocks
+		while (sb.remove(i)) {
+		}
+	}
+	assert(sb.isEmpty() == true);
+	it.first();
+	assert(it.valid() == false);
+	sb.add(5);
+	sb.add(5);
+	assert(sb.nrOccurrences(5) == 2);
+	sb.empty();
+	assert(sb.search(5) == false);
+}
+void testStaging(Relation r) {
+	cout << "Test staging" << endl;
+	SortedBag sb(r);
+	sb.setStaging(true);
+	for (int i = 0; i < 10000; i++) { //the size is exact while the elements are staged
+		sb.add((i * 7919) % 5000);
+		assert(sb.size() == i + 1);
+	}
+	assert(sb.isEmpty() == false);
+	assert(sb.nrOccurrences(7) == 2); //the first read merges the staged elements
+	for (int i = 0; i < 5000; i++) {
+		sb.add(i);
+	}
+	assert(sb.size() == 15000);
+	assert(sb.remove(4999) == true);
+	assert(sb.nrOccurrences(4999) == 2);
+	sb.add(-1);
+	assert(sb.search(-1) == true);
+	sb.add(-2);
+	SortedBagIterator it = sb.iterator();
+	assert(sb.search(-2) == true);
+	sb.add(-3);
+	it.first(); //restarting an iterator merges the elements staged after it was created
+	assert(it.getCurrent() == (r(-3, 0) ? -3 : 4999));
+	testIterator(sb, r);
+
+	SortedBag other(r);
+	other.setStaging(true);
+	for (int i = 0; i < 5000; i++) {
+		other.add(i);
+	}
+	sb.subtract(other); //both bags are merged before the set operation
+	assert(sb.size() == 14999 - 5000 + 3);
+	for (int i = 0; i < 5000; i++) {
+		assert(sb.nrOccurrences(i) == (i == 4999 ? 1 : 2));
+	}
+
+	sb.add(7);
+	sb.add(-4);
+	const SortedBag& constBag = sb; //reads through a const bag see the staged elements without merging them
+	assert(constBag.nrOccurrences(7) == 3);
+	assert(constBag.search(-4) == true);
+	assert(constBag.search(-5) == false);
+	assert(constBag.size() == 14999 - 5000 + 5);
+	other.add(7);
+	other.add(-4);
+	sb.subtract(other); //the staged elements of other take part in the set operation
+	assert(sb.nrOccurrences(7) == 1);
+	assert(sb.search(-4) == false);
+
+	sb.add(20000);
+	sb.setStaging(false); //turning the staging off merges the staged elements
+	sb.add(20000);
+	assert(sb.nrOccurrences(20000) == 2);
+	sb.setStaging(true);
+	sb.add(30000);
+	sb.empty();
+	assert(sb.size() == 0);
+	assert(sb.search(30000) == false);
+}
+void testFilter(Relation r) {
+	cout << "Test filter" << endl;
+	SortedBag sb(r);
+	for (int i = 0; i < 1000; i++) { //elements added before the filter is turned on
+		sb.add(2 * i);
+	}
+	sb.setFilter(true);
+	for (int i = 1000; i < 20000; i++) { //the filter grows with the bag
+		sb.add(2 * i);
+		sb.add(2 * i);
+	}
+	assert(sb.size() == 39000);
+	int present = 0;
+	for (int i = -1000; i < 41000; i++) {
+		if (sb.search(i))
+			present++;
+		assert(sb.nrOccurrences(i) == (i >= 0 && i < 40000 && i % 2 == 0 ? (i < 2000 ? 1 : 2) : 0));
+	}
+	assert(present == 20000);
+	long long lookups, rejected, falsePositives;
+	sb.filterStatistics(lookups, rejected, falsePositives);
+	assert(lookups == 2 * 42000);
+	assert(rejected + falsePositives == 2 * 22000); //every absent element is either rejected or a false positive
+	assert(falsePositives < 2 * 22000 / 20);
+
+	for (int i = 0; i < 20000; i = i + 2) { //removing more than half of the values rebuilds the filter
+		while (sb.remove(2 * i)) {
+		}
+	}
+	assert(sb.search(0) == false);
+	assert(sb.search(2) == true);
+	assert(sb.search(4) == false);
+	sb.setStaging(true);
+	sb.add(4);
+	assert(sb.search(4) == true); //the staged elements reach the filter when they are merged
+	sb.setStaging(false);
+
+	SortedBag other(r);
+	other.add(1);
+	sb.sumWith(other);
+	assert(sb.search(1) == true);
+	sb.empty();
+	assert(sb.search(2) == false);
+	sb.add(2);
+	assert(sb.search(2) == true);
+	sb.setFilter(false);
+	assert(sb.search(2) == true);
+	assert(sb.search(3) == false);
+}
 
 void testAllExtended() {
 	testCreate();
@@ -305,4 +755,20 @@ void testAllExtended() {
 	testIterator(relation3);
 	testQuantity(relation2);
 	testQuantity(relation3);
+	testSkipList(relation2);
+	testSkipList(relation3);
+	testHint(relation2);
+	testHint(relation3);
+	testAddAll(relation2);
+	testAddAll(relation3);
+	testSetOperations(relation2);
+	testSetOperations(relation3);
+	testErase(relation2);
+	testErase(relation3);
+	testUnrolled(relation2);
+	testUnrolled(relation3);
+	testStaging(relation2);
+	testStaging(relation3);
+	testFilter(relation2);
+	testFilter(relation3);
 }
@@ -1,132 +1,735 @@
 #include "SortedBag.h"
 #include "SortedBagIterator.h"
+#include <cstdint>
+#include <exception>
+#include <algorithm>
+#include <vector>
+
+using namespace std;
 
 SortedBag::SortedBag(Relation r) {
 	this->rel = r; // the relation used to sort the elements
 	this->head = nullptr; // the first node in the list
 	this->tail = nullptr; // the last node in the list
 	this->totalElements = 0; // the number of elements in the list
+	for (int l = 0; l < SKIP_LEVELS; l++) {
+		this->skipHead[l] = nullptr; // no node on any level yet
+	}
+	this->levels = 1;
+	this->seed = 2463534242u;
+	this->finger = nullptr; // nothing was added yet
+	this->slabs = nullptr; // no slab allocated yet
+	this->slabCursor = nullptr;
+	this->slabEnd = nullptr;
+	for (int h = 0; h <= SKIP_LEVELS; h++) {
+		this->freeNodes[h] = nullptr;
+	}
+	this->staging = false; // add inserts right away
+	this->filtering = false; // no Bloom filter
+	this->filterStorage = nullptr;
+	this->filter = nullptr;
+	this->filterBlocks = 0;
+	this->filterKeys = 0;
+	this->filterStale = 0;
+	this->filterLookups = 0;
+	this->filterRejections = 0;
+	this->filterFalsePositives = 0;
 }
 //Complexity BC=theta(1) WC=theta(1) Total=theta(1)
 
-void SortedBag::add(TComp e) {
-	// Check if the element already exists
-	// If it does, increment its frequency and return
-	// If it doesn't, create a new node and insert it in the correct position
+SortedBag::Node* SortedBag::nextOn(Node* n, int l) const {
+    if (n == nullptr)
+        return skipHead[l];
+    return l == 0 ? n->next : n->skip[l - 1];
+}
+// Complexity BC=theta(1) WC=theta(1) Total=theta(1)
 
-    Node* current = head;
-    while (current != nullptr) {
-        if (current->value == e) {
-            current->frequency++;
-            totalElements++;
-            return;
+void SortedBag::setNextOn(Node* n, int l, Node* next) {
+    if (n == nullptr) {
+        skipHead[l] = next;
+        if (l == 0)
+            head = next;
+    }
+    else if (l == 0)
+        n->next = next;
+    else
+        n->skip[l - 1] = next;
+}
+// Complexity BC=theta(1) WC=theta(1) Total=theta(1)
+
+bool SortedBag::before(TComp a, TComp b) const {
+    return a != b && rel(a, b);
+}
+// Complexity BC=theta(1) WC=theta(1) Total=theta(1)
+
+SortedBag::Node* SortedBag::findNode(TComp e, Node** update) const {
+	// Start on the highest level and go down one level every time the next node is not before e
+    Node* current = nullptr;
+    for (int l = levels - 1; l >= 0; l--) {
+        Node* next = nextOn(current, l);
+        while (next != nullptr && before(next->value, e)) {
+            current = next;
+            next = nextOn(current, l);
         }
-        current = current->next;
+        if (update != nullptr)
+            update[l] = current;
     }
+    Node* candidate = nextOn(current, 0);
+    if (candidate != nullptr && candidate->value == e)
+        return candidate;
+    return nullptr;
+}
+// Complexity BC=theta(1) WC=theta(n) Total=theta(log n) expected
 
-    // Not found  insert while preserving order
-    Node* newNode = new Node{ e, 1, nullptr, nullptr };
+int SortedBag::randomHeight() {
+    int height = 1;
+    while (height < SKIP_LEVELS) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        if ((seed & 3) != 0)
+            break;
+        height++;
+    }
+    return height;
+}
+// Complexity BC=theta(1) WC=theta(SKIP_LEVELS) Total=theta(1)
+
+SortedBag::Node* SortedBag::allocateNode(int height) {
+	// Reuse a released node of the same height if there is one
+	// Otherwise carve a block for the node and its skip pointers from the current slab
 
-    if (head == nullptr) {
-        head = tail = newNode;
+    if (freeNodes[height] != nullptr) {
+        Node* node = freeNodes[height];
+        freeNodes[height] = node->next;
+        return node;
     }
-    else if (!rel(head->value, e)) {
-        // Insert at beginning
-        newNode->next = head;
-        head->prev = newNode;
-        head = newNode;
+
+    int bytes = (int)((sizeof(Node) + (height - 1) * sizeof(Node*) + sizeof(Node*) - 1) / sizeof(Node*) * sizeof(Node*));
+    if (slabCursor == nullptr || slabCursor + bytes > slabEnd) {
+        char* slab = new char[SLAB_BYTES];
+        *(char**)slab = slabs;
+        slabs = slab;
+        uintptr_t first = ((uintptr_t)slab + sizeof(char*) + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+        slabCursor = (char*)first;
+        slabEnd = slab + SLAB_BYTES;
+    }
+
+    Node* node = (Node*)slabCursor;
+    slabCursor += bytes;
+    node->height = height;
+    node->skip = height > 1 ? (Node**)(node + 1) : nullptr;
+    return node;
+}
+// Complexity BC=theta(1) WC=theta(1) Total=theta(1)
+
+void SortedBag::releaseNode(Node* node) {
+    node->next = freeNodes[node->height];
+    freeNodes[node->height] = node;
+}
+// Complexity BC=theta(1) WC=theta(1) Total=theta(1)
+
+bool SortedBag::locateNear(TComp e, Node* start, Node*& previous) const {
+	// Walk forward while the next node comes before e, or backward while the current node does not
+	// Give up after FINGER_STEPS nodes
+
+    if (start == nullptr)
+        return false;
+    Node* current = start;
+    if (before(current->value, e)) {
+        for (int steps = 0; current->next != nullptr && before(current->next->value, e); steps++) {
+            if (steps == FINGER_STEPS)
+                return false;
+            current = current->next;
+        }
     }
     else {
-        current = head;
-        while (current != nullptr && rel(current->value, e)) {
+        for (int steps = 0; current != nullptr && !before(current->value, e); steps++) {
+            if (steps == FINGER_STEPS)
+                return false;
+            current = current->prev;
+        }
+    }
+    previous = current;
+    return true;
+}
+// Complexity BC=theta(1) WC=theta(FINGER_STEPS) Total=theta(1)
+
+void SortedBag::add(TComp e) {
+	// In staging mode, only append the element to the buffer
+	// Sorted and nearly sorted input lands next to the previous add, so the search starts there
+
+    if (staging) {
+        staged.push_back(e);
+        totalElements++;
+        return;
+    }
+    addNear(e, finger != nullptr ? finger : tail);
+}
+// Complexity BC=theta(1) WC=theta(n) Total=theta(log n) expected, theta(1) expected for nearly sorted input, theta(1) amortized in staging mode
+
+void SortedBag::add(TComp e, const SortedBagIterator& hint) {
+    if (&hint.bag != this)
+        throw exception();
+    if (staging) {
+        add(e);
+        return;
+    }
+    addNear(e, hint.currentNode != nullptr ? hint.currentNode : tail);
+}
+// Complexity BC=theta(1) WC=theta(n) Total=theta(log n) expected, theta(1) expected for a close hint
+
+void SortedBag::addNear(TComp e, Node* start) {
+	// Find the last node before e on every level, around start if possible, otherwise from the top level
+	// If the element exists, increment its frequency
+	// If it doesn't, create a new node and link it after the nodes found
+
+    Node* update[SKIP_LEVELS];
+    bool near = locateNear(e, start, update[0]);
+    Node* found = nullptr;
+    if (near) {
+        Node* candidate = nextOn(update[0], 0);
+        if (candidate != nullptr && candidate->value == e)
+            found = candidate;
+    }
+    else
+        found = findNode(e, update);
+
+    totalElements++;
+    if (found != nullptr) {
+        found->frequency++;
+        finger = found;
+        return;
+    }
+
+    int height = randomHeight();
+    if (near)
+        findPrevious(update, 1, height < levels ? height : levels);
+    for (int l = levels; l < height; l++) {
+        update[l] = nullptr;
+    }
+    levels = height > levels ? height : levels;
+
+    Node* newNode = allocateNode(height);
+    newNode->value = e;
+    newNode->frequency = 1;
+    for (int l = 0; l < height; l++) {
+        setNextOn(newNode, l, nextOn(update[l], l));
+        setNextOn(update[l], l, newNode);
+    }
+
+    newNode->prev = update[0];
+    if (newNode->next != nullptr)
+        newNode->next->prev = newNode;
+    else
+        tail = newNode;
+    finger = newNode;
+    if (filtering)
+        filterAdded(e);
+}
+// Complexity BC=theta(1) WC=theta(n) Total=theta(log n) expected
+
+void SortedBag::findPrevious(Node** update, int from, int to) const {
+	// The last node before a position on level l is the closest node before it that is tall enough
+
+    for (int l = from; l < to; l++) {
+        Node* previous = update[l - 1];
+        while (previous != nullptr && previous->height <= l) {
+            previous = previous->prev;
+        }
+        update[l] = previous;
+    }
+}
+// Complexity BC=theta(1) WC=theta(n) Total=theta(log n) expected for the levels of a node of random height
+
+void SortedBag::rebuildLevels() {
+	// Every node is linked after the last node seen so far that is tall enough for the level
+
+    Node* last[SKIP_LEVELS];
+    for (int l = 0; l < SKIP_LEVELS; l++) {
+        last[l] = nullptr;
+    }
+    levels = 1;
+    for (Node* current = head; current != nullptr; current = current->next) {
+        for (int l = 1; l < current->height; l++) {
+            setNextOn(last[l], l, current);
+            last[l] = current;
+        }
+        levels = current->height > levels ? current->height : levels;
+    }
+    for (int l = 1; l < SKIP_LEVELS; l++) {
+        setNextOn(last[l], l, nullptr);
+    }
+}
+// Complexity BC=theta(n) WC=theta(n) Total=theta(n)
+
+void SortedBag::addAll(const TComp* elems, int n) {
+	// Sort a copy of the elements with the relation and merge it into the list
+
+    if (n <= 0)
+        return;
+    vector<TComp> sorted(elems, elems + n);
+    sort(sorted.begin(), sorted.end(), [this](TComp a, TComp b) { return before(a, b); });
+    addSorted(sorted.data(), n);
+}
+// Complexity BC=theta(n log n + size) WC=theta(n log n + size) Total=theta(n log n + size)
+
+void SortedBag::addSorted(const TComp* sorted, int n) {
+	// Walk the list once, adding every run of equal elements to its node or linking a new node before the first node after it
+	// Relink the upper levels of the skip list at the end
+
+    Node* previous = nullptr;
+    Node* current = head;
+    for (int i = 0; i < n; ) {
+        TComp value = sorted[i];
+        int frequency = 0;
+        while (i < n && sorted[i] == value) {
+            frequency++;
+            i++;
+        }
+        while (current != nullptr && before(current->value, value)) {
+            previous = current;
             current = current->next;
         }
+        if (current != nullptr && current->value == value) {
+            current->frequency += frequency;
+            continue;
+        }
 
-        if (current == nullptr) {
-            // Insert at end
-            tail->next = newNode;
-            newNode->prev = tail;
+        Node* newNode = allocateNode(randomHeight());
+        newNode->value = value;
+        newNode->frequency = frequency;
+        newNode->prev = previous;
+        newNode->next = current;
+        if (previous != nullptr)
+            previous->next = newNode;
+        else
+            head = skipHead[0] = newNode;
+        if (current != nullptr)
+            current->prev = newNode;
+        else
             tail = newNode;
+        previous = newNode;
+    }
+    totalElements += n;
+    rebuildLevels();
+    if (filtering)
+        rebuildFilter();
+}
+// Complexity BC=theta(n + size) WC=theta(n + size) Total=theta(n + size)
+
+void SortedBag::setStaging(bool enabled) {
+    if (!enabled)
+        flush();
+    staging = enabled;
+}
+// Complexity BC=theta(1) WC=theta(k log k + n) Total=theta(k log k + n), where k is the number of staged elements
+
+void SortedBag::flush() {
+	// Sort the buffer in place and merge it into the list, the staged elements are already counted in totalElements
+	// The buffer keeps its capacity for the next burst of adds
+
+    if (staged.empty())
+        return;
+    int n = (int)staged.size();
+    sort(staged.begin(), staged.end(), [this](TComp a, TComp b) { return before(a, b); });
+    totalElements -= n;
+    addSorted(staged.data(), n);
+    staged.clear();
+}
+// Complexity BC=theta(1) WC=theta(k log k + n) Total=theta(k log k + n), where k is the number of staged elements
+
+int SortedBag::stagedOccurrences(TComp e) const {
+    int count = 0;
+    for (TComp s : staged) {
+        if (s == e)
+            count++;
+    }
+    return count;
+}
+// Complexity BC=theta(k) WC=theta(k) Total=theta(k), where k is the number of staged elements
+
+static int maxFrequency(int a, int b) {
+    return a > b ? a : b;
+}
+
+static int minFrequency(int a, int b) {
+    return a < b ? a : b;
+}
+
+static int differenceFrequency(int a, int b) {
+    return a > b ? a - b : 0;
+}
+
+static int sumFrequency(int a, int b) {
+    return a + b;
+}
+
+void SortedBag::merge(const SortedBag& other, int (*combine)(int, int)) {
+	// Merge the staged elements of the bag into its list
+	// The staged elements of other are not in its list and other cannot be changed,
+	// so they are merged with a copy of its list first
+
+    if (other.rel != rel)
+        throw exception();
+    flush();
+    if (other.staged.empty()) {
+        mergeNodes(other.head, combine);
+        return;
+    }
+    SortedBag whole(rel);
+    whole.addAll(other.staged.data(), (int)other.staged.size());
+    whole.mergeNodes(other.head, sumFrequency);
+    mergeNodes(whole.head, combine);
+}
+// Complexity BC=theta(n + m) WC=theta(n + m + k log k) Total=theta(n + m + k log k), where k is the number of staged elements of other
+
+void SortedBag::mergeNodes(const Node* otherHead, int (*combine)(int, int)) {
+	// Walk both lists at the same time, like the merge step of merge sort
+	// Every node kept or created is linked after the previous one, the nodes whose frequency becomes 0 are released
+	// The next nodes are read before relinking, so merging a bag with itself works too
+
+    Node* current = head;
+    const Node* otherCurrent = otherHead;
+    Node* previous = nullptr;
+    head = nullptr;
+    totalElements = 0;
+    while (current != nullptr || otherCurrent != nullptr) {
+        Node* node = nullptr;
+        int frequency;
+        if (otherCurrent == nullptr || (current != nullptr && before(current->value, otherCurrent->value))) {
+            node = current;
+            current = current->next;
+            frequency = combine(node->frequency, 0);
+        }
+        else if (current == nullptr || before(otherCurrent->value, current->value)) {
+            frequency = combine(0, otherCurrent->frequency);
+            if (frequency > 0) {
+                node = allocateNode(randomHeight());
+                node->value = otherCurrent->value;
+            }
+            otherCurrent = otherCurrent->next;
         }
         else {
-            // Insert in middle
-            newNode->next = current;
-            newNode->prev = current->prev;
-            current->prev->next = newNode;
-            current->prev = newNode;
+            node = current;
+            frequency = combine(current->frequency, otherCurrent->frequency);
+            current = current->next;
+            otherCurrent = otherCurrent->next;
+        }
+
+        if (node == nullptr)
+            continue;
+        if (frequency == 0) {
+            releaseNode(node);
+            continue;
         }
+        node->frequency = frequency;
+        node->prev = previous;
+        if (previous != nullptr)
+            previous->next = node;
+        else
+            head = node;
+        previous = node;
+        totalElements += frequency;
     }
+    if (previous != nullptr)
+        previous->next = nullptr;
+    tail = previous;
+    skipHead[0] = head;
+    finger = nullptr;
+    rebuildLevels();
+    if (filtering)
+        rebuildFilter();
+}
+// Complexity BC=theta(n + m) WC=theta(n + m) Total=theta(n + m)
 
-    totalElements++;
+void SortedBag::unionWith(const SortedBag& other) {
+    merge(other, maxFrequency);
 }
-// Complexity BC=theta(1) WC=theta(n) Total=theta(n)
+// Complexity BC=theta(n + m) WC=theta(n + m) Total=theta(n + m)
+
+void SortedBag::intersectWith(const SortedBag& other) {
+    merge(other, minFrequency);
+}
+// Complexity BC=theta(n + m) WC=theta(n + m) Total=theta(n + m)
+
+void SortedBag::subtract(const SortedBag& other) {
+    merge(other, differenceFrequency);
+}
+// Complexity BC=theta(n + m) WC=theta(n + m) Total=theta(n + m)
+
+void SortedBag::sumWith(const SortedBag& other) {
+    merge(other, sumFrequency);
+}
+// Complexity BC=theta(n + m) WC=theta(n + m) Total=theta(n + m)
 
 bool SortedBag::remove(TComp e) {
-	// Check if the element exists
-	// If it does, decrement its frequency
-	// If the frequency becomes 0, remove the node from the list
+	// Search for the element with the skip list
+	// If it exists, remove one occurrence from its node
 	// If it doesn't exist, return false
-    Node* current = head;
-    while (current != nullptr && current->value != e) {
-        current = current->next;
-    }
 
+    flush();
+    Node* update[SKIP_LEVELS];
+    Node* current = findNode(e, update);
     if (current == nullptr)
         return false;
+    removeFrom(current, 1, update);
+    return true;
+}
+// Complexity BC=theta(log n) WC=theta(n) Total=theta(log n) expected
 
-    current->frequency--;
-    totalElements--;
-    if (current->frequency == 0) {
-        if (current == head && current == tail) {
-            head = tail = nullptr;
-        }
-        else if (current == head) {
-            head = head->next;
-            head->prev = nullptr;
-        }
-        else if (current == tail) {
-            tail = tail->prev;
-            tail->next = nullptr;
+void SortedBag::removeFrom(Node* node, int count, Node** update) {
+	// Decrement the frequency of the node
+	// If the frequency becomes 0, unlink the node from every level it is on
+
+    node->frequency -= count;
+    totalElements -= count;
+    if (node->frequency > 0)
+        return;
+
+    Node* previous[SKIP_LEVELS];
+    if (update == nullptr) {
+        previous[0] = node->prev;
+        findPrevious(previous, 1, node->height);
+        update = previous;
+    }
+    for (int l = 0; l < node->height; l++) {
+        setNextOn(update[l], l, nextOn(node, l));
+    }
+    if (node->next != nullptr)
+        node->next->prev = node->prev;
+    else
+        tail = node->prev;
+    while (levels > 1 && skipHead[levels - 1] == nullptr) {
+        levels--;
+    }
+    if (finger == node)
+        finger = node->prev;
+    releaseNode(node);
+    if (filtering)
+        filterRemoved();
+}
+// Complexity BC=theta(1) WC=theta(n) Total=theta(1) expected
+
+int SortedBag::eraseRange(SortedBagIterator& begin, const SortedBagIterator& end) {
+	// Remove the occurrences after the position of begin in its node, then every node up to the node of end,
+	// then the occurrences before the position of end in its node
+	// All the removed nodes are consecutive, so the last nodes before them on every level are found only once
+
+    if (&begin.bag != this || &end.bag != this)
+        throw exception();
+    flush();
+    Node* node = begin.currentNode;
+    if (node == nullptr)
+        return 0;
+    if (node == end.currentNode) {
+        int count = end.frequencyIndex - begin.frequencyIndex;
+        if (count <= 0)
+            return 0;
+        removeFrom(node, count, nullptr);
+        return count;
+    }
+
+    Node* update[SKIP_LEVELS];
+    int known; // update is filled for the levels below known
+    int removed = 0;
+    if (begin.frequencyIndex > 1) {
+        int count = node->frequency - begin.frequencyIndex + 1;
+        removeFrom(node, count, nullptr);
+        removed += count;
+        for (int l = 0; l < node->height; l++) {
+            update[l] = node;
         }
-        else {
-            current->prev->next = current->next;
-            current->next->prev = current->prev;
+        known = node->height;
+        node = node->next;
+    }
+    else {
+        update[0] = node->prev;
+        known = 1;
+    }
+
+    while (node != end.currentNode) {
+        Node* next = node->next;
+        if (node->height > known) {
+            findPrevious(update, known, node->height);
+            known = node->height;
         }
-        delete current;
+        removed += node->frequency;
+        removeFrom(node, node->frequency, update);
+        node = next;
+    }
+    if (node != nullptr && end.frequencyIndex > 1) {
+        removeFrom(node, end.frequencyIndex - 1, update);
+        removed += end.frequencyIndex - 1;
     }
 
+    begin.currentNode = node;
+    begin.frequencyIndex = 1;
+    return removed;
+}
+// Complexity BC=theta(1) WC=theta(n) Total=theta(k) expected, where k is the number of distinct elements removed
+
+static unsigned long long mix(unsigned long long x) {
+    // splitmix64 finalizer, every bit of x changes about half of the bits of the result
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+// Complexity BC=theta(1) WC=theta(1) Total=theta(1)
+
+static unsigned long long filterHash(TComp e) {
+    return mix((unsigned long long)(unsigned int)e + 0x9E3779B97F4A7C15ULL);
+}
+// Complexity BC=theta(1) WC=theta(1) Total=theta(1)
+
+static unsigned long long filterBlockIndex(unsigned long long h, int blocks) {
+    // the positions inside the block use the low 54 bits of h, so the block is taken from a second mix of h
+    return mix(h) & (unsigned long long)(blocks - 1);
+}
+// Complexity BC=theta(1) WC=theta(1) Total=theta(1)
+
+bool SortedBag::filterMayContain(TComp e) const {
+    // every 9 of the low 54 bits of the hash pick one of the 512 bits of the block
+    unsigned long long h = filterHash(e);
+    const unsigned long long* block = filter + filterBlockIndex(h, filterBlocks) * FILTER_BLOCK_WORDS;
+    for (int i = 0; i < FILTER_HASHES; i++) {
+        int bit = (int)(h >> (9 * i) & 511);
+        if ((block[bit >> 6] & 1ULL << (bit & 63)) == 0)
+            return false;
+    }
     return true;
 }
-// Complexity BC=theta(1) WC=theta(n) Total=theta(n)
+// Complexity BC=theta(1) WC=theta(FILTER_HASHES) Total=theta(1)
 
-bool SortedBag::search(TComp elem) const {
-	// Check if the element exists in the list
-	// If it does, return true
-	// If it doesn't, return false
+void SortedBag::filterSet(TComp e) {
+    unsigned long long h = filterHash(e);
+    unsigned long long* block = filter + filterBlockIndex(h, filterBlocks) * FILTER_BLOCK_WORDS;
+    for (int i = 0; i < FILTER_HASHES; i++) {
+        int bit = (int)(h >> (9 * i) & 511);
+        block[bit >> 6] |= 1ULL << (bit & 63);
+    }
+}
+// Complexity BC=theta(FILTER_HASHES) WC=theta(FILTER_HASHES) Total=theta(1)
 
-    Node* current = head;
-    while (current != nullptr) {
-        if (current->value == elem)
-            return true;
-        current = current->next;
+void SortedBag::filterAdded(TComp e) {
+    filterKeys++;
+    if ((long long)filterKeys * FILTER_BITS_PER_KEY > (long long)filterBlocks * FILTER_BLOCK_WORDS * 64)
+        rebuildFilter();
+    else
+        filterSet(e);
+}
+// Complexity BC=theta(1) WC=theta(n) Total=theta(1) amortized
+
+void SortedBag::filterRemoved() {
+    filterStale++;
+    if (2 * filterStale > filterKeys)
+        rebuildFilter();
+}
+// Complexity BC=theta(1) WC=theta(n) Total=theta(1) amortized
+
+void SortedBag::rebuildFilter() {
+	// Count the nodes, take the smallest power of 2 of blocks giving every node FILTER_BITS_PER_KEY bits
+	// Allocate the blocks aligned to a cache line and set the bits of every node
+
+    int nodes = 0;
+    for (Node* current = head; current != nullptr; current = current->next) {
+        nodes++;
+    }
+    int blocks = 1;
+    while ((long long)blocks * FILTER_BLOCK_WORDS * 64 < (long long)nodes * FILTER_BITS_PER_KEY) {
+        blocks *= 2;
+    }
+    if (blocks != filterBlocks) {
+        delete[] filterStorage;
+        filterStorage = new unsigned long long[blocks * FILTER_BLOCK_WORDS + CACHE_LINE / sizeof(unsigned long long)];
+        uintptr_t first = ((uintptr_t)filterStorage + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+        filter = (unsigned long long*)first;
+        filterBlocks = blocks;
+    }
+    for (int i = 0; i < blocks * FILTER_BLOCK_WORDS; i++) {
+        filter[i] = 0;
+    }
+    for (Node* current = head; current != nullptr; current = current->next) {
+        filterSet(current->value);
+    }
+    filterKeys = nodes;
+    filterStale = 0;
+}
+// Complexity BC=theta(n) WC=theta(n) Total=theta(n)
+
+void SortedBag::setFilter(bool enabled) {
+    flush();
+    filtering = enabled;
+    if (enabled) {
+        rebuildFilter();
+        filterLookups = filterRejections = filterFalsePositives = 0;
+    }
+    else {
+        delete[] filterStorage;
+        filterStorage = filter = nullptr;
+        filterBlocks = 0;
     }
-    return false;
 }
 // Complexity BC=theta(1) WC=theta(n) Total=theta(n)
 
-int SortedBag::nrOccurrences(TComp elem) const {
+void SortedBag::filterStatistics(long long& lookups, long long& rejected, long long& falsePositives) const {
+    lookups = filterLookups;
+    rejected = filterRejections;
+    falsePositives = filterFalsePositives;
+}
+// Complexity BC=theta(1) WC=theta(1) Total=theta(1)
+
+SortedBag::Node* SortedBag::lookup(TComp e) const {
+	// Without the filter, search with the skip list
+	// With it, stop when the filter rejects e, and count the searches it let through that find nothing
+
+    if (!filtering)
+        return findNode(e, nullptr);
+    filterLookups++;
+    if (!filterMayContain(e)) {
+        filterRejections++;
+        return nullptr;
+    }
+    Node* found = findNode(e, nullptr);
+    if (found == nullptr)
+        filterFalsePositives++;
+    return found;
+}
+// Complexity BC=theta(1) WC=theta(n) Total=theta(log n) expected, theta(1) for most absent elements
+
+bool SortedBag::search(TComp elem) {
+	// Merge the staged elements, then check if the element exists in the list
+
+    flush();
+    return lookup(elem) != nullptr;
+}
+// Complexity BC=theta(1) WC=theta(n) Total=theta(log n) expected, theta(1) for most absent elements with the filter
+
+bool SortedBag::search(TComp elem) const {
 	// Check if the element exists in the list
+	// If it doesn't, check the staged elements
+
+    return lookup(elem) != nullptr || stagedOccurrences(elem) > 0;
+}
+// Complexity BC=theta(1) WC=theta(n + k) Total=theta(log n + k) expected, where k is the number of staged elements
+
+int SortedBag::nrOccurrences(TComp elem) {
+	// Merge the staged elements, then check if the element exists in the list
 	// If it does, return its frequency
 
-    Node* current = head;
-    while (current != nullptr) {
-        if (current->value == elem)
-            return current->frequency;
-        current = current->next;
-    }
-    return 0;
+    flush();
+    Node* found = lookup(elem);
+    return found != nullptr ? found->frequency : 0;
 }
-// Complexity BC=theta(1) WC=theta(n) Total=theta(n)
+// Complexity BC=theta(1) WC=theta(n) Total=theta(log n) expected, theta(1) for most absent elements with the filter
+
+int SortedBag::nrOccurrences(TComp elem) const {
+	// Add the frequency of the element in the list and its occurrences among the staged elements
+
+    Node* found = lookup(elem);
+    return (found != nullptr ? found->frequency : 0) + stagedOccurrences(elem);
+}
+// Complexity BC=theta(1) WC=theta(n + k) Total=theta(log n + k) expected, where k is the number of staged elements
 
 
 int SortedBag::size() const {
@@ -140,27 +743,49 @@ bool SortedBag::isEmpty() const {
 //Complexity BC=theta(1) WC=theta(1) Total=theta(1)
 
 SortedBagIterator SortedBag::iterator() {
+	flush();
 	return SortedBagIterator(*this);
 }
 // Complexity BC=theta(1) WC=theta(1) Total=theta(1)
 
 void SortedBag::empty() {
-	// Delete all nodes in the list
+	// Free the slabs, which releases all nodes at once
 	// Set head and tail to nullptr
 	// Set totalElements to 0
 
-    Node* current = head;
-    while (current != nullptr) {
-        Node* temp = current;
-        current = current->next;
-        delete temp;
+    while (slabs != nullptr) {
+        char* previous = *(char**)slabs;
+        delete[] slabs;
+        slabs = previous;
+    }
+    slabCursor = slabEnd = nullptr;
+    for (int h = 0; h <= SKIP_LEVELS; h++) {
+        freeNodes[h] = nullptr;
     }
     head = tail = nullptr;
+    finger = nullptr;
+    for (int l = 0; l < SKIP_LEVELS; l++) {
+        skipHead[l] = nullptr;
+    }
+    levels = 1;
+    staged.clear();
     totalElements = 0;
+    if (filtering)
+        rebuildFilter();
 }
-// Complexity BC=theta(1) WC=theta(n) Total=theta(n)
+// Complexity BC=theta(1) WC=theta(slabs) Total=theta(slabs)
+
+int SortedBag::slabCount() const {
+    int count = 0;
+    for (char* slab = slabs; slab != nullptr; slab = *(char**)slab) {
+        count++;
+    }
+    return count;
+}
+// Complexity BC=theta(1) WC=theta(slabs) Total=theta(slabs)
 
 SortedBag::~SortedBag() {
     empty();
+    delete[] filterStorage;
 }
-// Complexity BC=theta(1) WC=theta(n) Total=theta(n)
\ No newline at end of file
+// Complexity BC=theta(1) WC=theta(slabs) Total=theta(slabs)
\ No newline at end of file
@@ -1,4 +1,5 @@
 #pragma once
+#include <vector>
 
 typedef int TComp;
 typedef TComp TElem;
@@ -7,6 +8,21 @@ typedef bool(*Relation)(TComp, TComp);
 
 class SortedBagIterator;
 
+// maximum height of a node in the skip list over the nodes
+#define SKIP_LEVELS 16
+
+// number of nodes the finger of add may walk before falling back to a search from the top level
+#define FINGER_STEPS 8
+
+// size of the blocks the nodes are carved from, and the alignment of their first node
+#define SLAB_BYTES 16384
+#define CACHE_LINE 64
+
+// the Bloom filter sets FILTER_HASHES bits of one cache line for every value, and gets FILTER_BITS_PER_KEY bits per value
+#define FILTER_BLOCK_WORDS 8
+#define FILTER_HASHES 6
+#define FILTER_BITS_PER_KEY 16
+
 class SortedBag {
 	friend class SortedBagIterator;
 
@@ -16,6 +32,8 @@ private:
 		int frequency;
 		Node* next;
 		Node* prev;
+		int height; // number of skip list levels the node is on, level 0 is the next/prev list
+		Node** skip; // skip[l - 1] = next node on level l, for 1 <= l < height, stored right after the node
 	};
 
 	Node* head;
@@ -23,6 +41,103 @@ private:
 	Relation rel;
 	int totalElements;
 
+	Node* skipHead[SKIP_LEVELS]; // first node on every level, skipHead[0] == head
+	int levels; // number of levels in use
+	unsigned int seed; // state of the generator for node heights
+
+	// slab allocator for the nodes
+	char* slabs; // most recent slab, every slab starts with a pointer to the previous one
+	char* slabCursor; // first free byte of the most recent slab
+	char* slabEnd; // end of the most recent slab
+	Node* freeNodes[SKIP_LEVELS + 1]; // freeNodes[h] = released nodes of height h, linked through next
+
+	// returns an uninitialized node of the given height, from a free list or from the current slab
+	Node* allocateNode(int height);
+
+	// puts a node back on the free list of its height
+	void releaseNode(Node* node);
+
+	// next node after n on level l, the first node of the level if n is nullptr
+	Node* nextOn(Node* n, int l) const;
+	void setNextOn(Node* n, int l, Node* next);
+
+	// checks whether a comes strictly before b in the order given by rel
+	bool before(TComp a, TComp b) const;
+
+	// fills update[l] with the last node on level l that comes before e (nullptr if there is none)
+	// and returns the node holding e, or nullptr if e is not in the bag
+	Node* findNode(TComp e, Node** update) const;
+
+	// random height, every level is kept with probability 1/4
+	int randomHeight();
+
+	Node* finger; // node touched by the last add, where the next add starts looking
+
+	// walks at most FINGER_STEPS nodes from start to find the last node before e (nullptr if there is none)
+	// returns false if e is too far from start
+	bool locateNear(TComp e, Node* start, Node*& previous) const;
+
+	// adds e, looking for its position around start first
+	void addNear(TComp e, Node* start);
+
+	// fills update[l] for from <= l < to with the last node on level l before update[from - 1] or equal to it,
+	// walking prev back to the closest node that is tall enough
+	void findPrevious(Node** update, int from, int to) const;
+
+	// removes count occurrences from node, which must have at least count
+	// if none is left, the node is unlinked using update (the last nodes before it on its levels)
+	// or, if update is nullptr, the nodes found by walking prev
+	void removeFrom(Node* node, int count, Node** update);
+
+	// relinks levels 1 and above of the skip list by walking level 0 once
+	void rebuildLevels();
+
+	// merges n elements, already sorted by rel, into the list in a single walk
+	void addSorted(const TComp* sorted, int n);
+
+	bool staging; // whether add appends to staged instead of inserting
+	std::vector<TComp> staged; // elements added but not yet in the list, counted in totalElements
+
+	// number of occurrences of e in staged, for reads that cannot flush
+	int stagedOccurrences(TComp e) const;
+
+	// blocked Bloom filter over the values of the nodes, checked by search and nrOccurrences before the skip list
+	bool filtering; // whether the filter is kept up to date
+	unsigned long long* filterStorage; // allocation holding the filter
+	unsigned long long* filter; // FILTER_BLOCK_WORDS words for every block, aligned to a cache line
+	int filterBlocks; // number of blocks, a power of 2
+	int filterKeys; // values inserted since the last rebuild
+	int filterStale; // values removed from the bag since the last rebuild, their bits are still set
+	mutable long long filterLookups; // lookups checked by the filter
+	mutable long long filterRejections; // lookups the filter answered alone
+	mutable long long filterFalsePositives; // lookups of absent values the filter let through
+
+	// checks whether e may be in the bag, false means e is certainly not in it
+	bool filterMayContain(TComp e) const;
+
+	// sets the bits of e
+	void filterSet(TComp e);
+
+	// records a new value of the bag, growing the filter when it holds more values than it was sized for
+	void filterAdded(TComp e);
+
+	// records a value that left the bag, rebuilding the filter when more than half of its values are gone
+	void filterRemoved();
+
+	// sizes the filter for the values of the bag and sets their bits
+	void rebuildFilter();
+
+	// returns the node holding e, or nullptr if e is not in the bag, asking the filter first
+	Node* lookup(TComp e) const;
+
+	// merges other, including its staged elements, into the bag
+	// every value gets the frequency combine(frequency here, frequency in other), values reaching 0 are removed
+	// throws exception if the bags do not use the same relation
+	void merge(const SortedBag& other, int (*combine)(int, int));
+
+	// merges the list starting at otherHead into the bag in a single walk over both lists
+	void mergeNodes(const Node* otherHead, int (*combine)(int, int));
+
 public:
 	//constructor
 	SortedBag(Relation r);
@@ -30,14 +145,67 @@ public:
 	//adds an element to the sorted bag
 	void add(TComp e);
 
+	//adds an element to the sorted bag, starting the search from the position of hint
+	//a hint close to the position of e makes the add constant time
+	//the hint must not have been invalidated by removing its current element
+	//throws exception if the hint belongs to another bag
+	void add(TComp e, const SortedBagIterator& hint);
+
+	//adds the n elements of elems to the sorted bag
+	//the elements are sorted first and merged into the bag in a single walk
+	void addAll(const TComp* elems, int n);
+
+	//every element occurs as many times as in the bag or in other, whichever is more
+	void unionWith(const SortedBag& other);
+
+	//every element occurs as many times as in the bag or in other, whichever is less
+	void intersectWith(const SortedBag& other);
+
+	//removes from the bag one occurrence for every occurrence of an element in other
+	void subtract(const SortedBag& other);
+
+	//adds all the occurrences of the elements of other to the bag
+	void sumWith(const SortedBag& other);
+
+	//turns the staging mode on or off, turning it off flushes the staged elements
+	//in staging mode add only appends the element to a buffer, which is merged into the bag by the first read through a non-const bag
+	void setStaging(bool enabled);
+
+	//sorts the staged elements and merges them into the bag in a single walk
+	void flush();
+
+	//turns the Bloom filter on or off, while it is on most lookups of absent elements do not search the bag
+	//turning it on resets the statistics of the filter
+	void setFilter(bool enabled);
+
+	//returns the number of lookups checked by the filter, how many it rejected,
+	//and how many lookups of absent elements it did not reject
+	void filterStatistics(long long& lookups, long long& rejected, long long& falsePositives) const;
+
 	//removes one occurence of an element from a sorted bag
 	//returns true if an eleent was removed, false otherwise (if e was not part of the sorted bag)
 	bool remove(TComp e);
 
+	//removes the elements from the position of begin up to, but not including, the position of end
+	//end must not come before begin, an invalid end removes everything after begin
+	//begin is moved to the position of end, other iterators on the bag may become invalid
+	//returns the number of elements removed, throws exception if an iterator belongs to another bag
+	int eraseRange(SortedBagIterator& begin, const SortedBagIterator& end);
+
 	//checks if an element appearch is the sorted bag
+	//merges the staged elements first
+	bool search(TComp e);
+
+	//checks if an element appears in a const sorted bag
+	//the staged elements cannot be merged, so they are searched one by one
 	bool search(TComp e) const;
 
 	//returns the number of occurrences for an element in the sorted bag
+	//merges the staged elements first
+	int nrOccurrences(TComp e);
+
+	//returns the number of occurrences for an element in a const sorted bag
+	//the staged elements cannot be merged, so they are counted one by one
 	int nrOccurrences(TComp e) const;
 
 	//returns the number of elements from the sorted bag
@@ -51,6 +219,9 @@ public:
 
 	void empty();
 
+	//returns the number of slabs the nodes are currently carved from
+	int slabCount() const;
+
 	//destructor
 	~SortedBag();
 };
\ No newline at end of file
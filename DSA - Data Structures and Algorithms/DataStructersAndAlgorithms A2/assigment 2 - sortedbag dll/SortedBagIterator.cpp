@@ -4,7 +4,7 @@
 
 using namespace std;
 
-SortedBagIterator::SortedBagIterator(const SortedBag& b) : bag(b) {
+SortedBagIterator::SortedBagIterator(SortedBag& b) : bag(b) {
 	// constructor
 	first();
 }
@@ -44,30 +44,58 @@ void SortedBagIterator::next() {
 void SortedBagIterator::first() {
 	//moves the iterator to the first element of the sorted bag
 	//if the sorted bag is empty, the iterator is invalid
+	//the elements staged since the iterator was created are merged first
 
+	bag.flush();
 	currentNode = bag.head;
 	frequencyIndex = 1;
 }
-//Complexity BC=theta(1) WC=theta(1) Total=theta(1)
+//Complexity BC=theta(1) WC=theta(k log k + n) Total=theta(1) if nothing is staged
+
+int SortedBagIterator::eraseCurrent(int count) {
+	//the occurrences before the current one stay, the iterator moves to the next node if none is left after it
+	SortedBag::Node* node = currentNode;
+	if (frequencyIndex > node->frequency - count) {
+		currentNode = node->next;
+		frequencyIndex = 1;
+	}
+	bag.removeFrom(node, count, nullptr);
+	return count;
+}
+//Complexity BC=theta(1) WC=theta(n) Total=theta(1) expected
 
 int SortedBagIterator::removeOccurences(int nr, TComp elem) {
-	//removes nr occurrences of elem. If element appears less than nr times, it removes all occurrences
+	//removes nr occurrences of elem, starting from the current position. If element appears less than nr times from there, it removes all of them
 	//returns the number of occurrences removed
 	//throws an exception if nr is negative
 	if (nr < 0)
 		throw exception();
-	int removed = 0;
-	while (valid() && currentNode->value == elem && removed < nr) {
-		removed++;
-		if (frequencyIndex < currentNode->frequency) {
-			currentNode->frequency--;
-			frequencyIndex++;
-		}
-		else {
-			currentNode = currentNode->next;
-			frequencyIndex = 1;
-		}
-	}
-	return removed;
+	if (!valid() || currentNode->value != elem)
+		return 0;
+	int left = currentNode->frequency - frequencyIndex + 1;
+	if (nr > left)
+		nr = left;
+	if (nr == 0)
+		return 0;
+	return eraseCurrent(nr);
+}
+//Complexity BC=theta(1) WC=theta(n) Total=theta(1) expected
+
+void SortedBagIterator::erase() {
+	//removes the current element
+	//throws an exception if the iterator is not valid
+	if (!valid())
+		throw exception();
+	eraseCurrent(1);
+}
+//Complexity BC=theta(1) WC=theta(n) Total=theta(1) expected
+
+int SortedBagIterator::eraseAll() {
+	//removes every occurrence of the current element, including the ones before the current position
+	//throws an exception if the iterator is not valid
+	if (!valid())
+		throw exception();
+	frequencyIndex = 1;
+	return eraseCurrent(currentNode->frequency);
 }
-//Complexity BC=theta(1) WC=theta(nr) Total=theta(nr)
\ No newline at end of file
+//Complexity BC=theta(1) WC=theta(n) Total=theta(1) expected
@@ -8,17 +8,28 @@ class SortedBagIterator
 	friend class SortedBag;
 
 private:
-	const SortedBag& bag;
-	SortedBagIterator(const SortedBag& b);
+	SortedBag& bag;
+	SortedBagIterator(SortedBag& b);
 
 	SortedBag::Node* currentNode;
 	int frequencyIndex;
 
+	// removes count occurrences of the current element, starting with the current one
+	int eraseCurrent(int count);
+
 public:
 	TComp getCurrent();
 	bool valid();
 	void next();
 	void first();
 	int removeOccurences(int nr, TComp elem);
+
+	//removes the current element, the iterator moves to the next one
+	//throws exception if the iterator is not valid
+	void erase();
+
+	//removes all the occurrences of the current element, the iterator moves to the next element
+	//returns the number of elements removed, throws exception if the iterator is not valid
+	int eraseAll();
 };
 
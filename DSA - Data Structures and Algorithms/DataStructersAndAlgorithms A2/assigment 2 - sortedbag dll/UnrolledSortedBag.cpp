@@ -0,0 +1,218 @@
+#include "UnrolledSortedBag.h"
+#include "UnrolledSortedBagIterator.h"
+
+UnrolledSortedBag::UnrolledSortedBag(Relation r) {
+	this->rel = r; // the relation used to sort the elements
+	this->head = nullptr; // the first block in the list
+	this->tail = nullptr; // the last block in the list
+	this->totalElements = 0; // the number of elements in the bag
+}
+// Complexity BC=theta(1) WC=theta(1) Total=theta(1)
+
+bool UnrolledSortedBag::before(TComp a, TComp b) const {
+    return a != b && rel(a, b);
+}
+// Complexity BC=theta(1) WC=theta(1) Total=theta(1)
+
+UnrolledSortedBag::Block* UnrolledSortedBag::findBlock(TComp e) const {
+	// Elements that do not come before the first value of the last block belong to the last block
+	// Otherwise skip the blocks whose last value comes before e, without looking inside them
+
+    if (head == nullptr)
+        return nullptr;
+    if (!before(e, tail->values[0]))
+        return tail;
+    Block* block = head;
+    while (block->next != nullptr && before(block->values[block->count - 1], e)) {
+        block = block->next;
+    }
+    return block;
+}
+// Complexity BC=theta(1) WC=theta(n / BLOCK_CAPACITY) Total=theta(n / BLOCK_CAPACITY)
+
+int UnrolledSortedBag::position(const Block* block, TComp e) const {
+    int i = 0;
+    while (i < block->count && before(block->values[i], e)) {
+        i++;
+    }
+    return i;
+}
+// Complexity BC=theta(1) WC=theta(BLOCK_CAPACITY) Total=theta(BLOCK_CAPACITY)
+
+void UnrolledSortedBag::split(Block* block) {
+	// The first half of the values stays, the second half is moved to a new block linked after it
+
+    Block* newBlock = new Block;
+    int kept = block->count / 2;
+    newBlock->count = block->count - kept;
+    for (int i = 0; i < newBlock->count; i++) {
+        newBlock->values[i] = block->values[kept + i];
+        newBlock->frequencies[i] = block->frequencies[kept + i];
+    }
+    block->count = kept;
+
+    newBlock->prev = block;
+    newBlock->next = block->next;
+    if (block->next != nullptr)
+        block->next->prev = newBlock;
+    else
+        tail = newBlock;
+    block->next = newBlock;
+}
+// Complexity BC=theta(BLOCK_CAPACITY) WC=theta(BLOCK_CAPACITY) Total=theta(BLOCK_CAPACITY)
+
+void UnrolledSortedBag::join(Block* first, Block* second) {
+    for (int i = 0; i < second->count; i++) {
+        first->values[first->count + i] = second->values[i];
+        first->frequencies[first->count + i] = second->frequencies[i];
+    }
+    first->count += second->count;
+
+    first->next = second->next;
+    if (second->next != nullptr)
+        second->next->prev = first;
+    else
+        tail = first;
+    delete second;
+}
+// Complexity BC=theta(1) WC=theta(BLOCK_CAPACITY) Total=theta(BLOCK_CAPACITY)
+
+void UnrolledSortedBag::rebalance(Block* block) {
+	// An empty block is unlinked and freed
+	// A block less than half full is merged with the next block, or else the previous one, if they fit in one block
+
+    if (block->count == 0) {
+        if (block->prev != nullptr)
+            block->prev->next = block->next;
+        else
+            head = block->next;
+        if (block->next != nullptr)
+            block->next->prev = block->prev;
+        else
+            tail = block->prev;
+        delete block;
+        return;
+    }
+    if (block->count >= BLOCK_CAPACITY / 2)
+        return;
+    if (block->next != nullptr && block->count + block->next->count <= BLOCK_CAPACITY)
+        join(block, block->next);
+    else if (block->prev != nullptr && block->prev->count + block->count <= BLOCK_CAPACITY)
+        join(block->prev, block);
+}
+// Complexity BC=theta(1) WC=theta(BLOCK_CAPACITY) Total=theta(BLOCK_CAPACITY)
+
+void UnrolledSortedBag::add(TComp e) {
+	// Find the block of e and the position of e inside it
+	// If the element exists, increment its frequency
+	// If it doesn't, shift the bigger values of the block to make room for it, splitting the block first if it is full
+
+    Block* block = findBlock(e);
+    totalElements++;
+    if (block == nullptr) {
+        block = new Block;
+        block->next = nullptr;
+        block->prev = nullptr;
+        block->count = 0;
+        head = tail = block;
+    }
+
+    int i = position(block, e);
+    if (i < block->count && block->values[i] == e) {
+        block->frequencies[i]++;
+        return;
+    }
+    if (block->count == BLOCK_CAPACITY) {
+        split(block);
+        if (i > block->count) {
+            i -= block->count;
+            block = block->next;
+        }
+    }
+    for (int j = block->count; j > i; j--) {
+        block->values[j] = block->values[j - 1];
+        block->frequencies[j] = block->frequencies[j - 1];
+    }
+    block->values[i] = e;
+    block->frequencies[i] = 1;
+    block->count++;
+}
+// Complexity BC=theta(1) WC=theta(n / BLOCK_CAPACITY) Total=theta(n / BLOCK_CAPACITY), theta(1) for elements added after the first value of the last block
+
+bool UnrolledSortedBag::remove(TComp e) {
+	// Find the block of e and the position of e inside it
+	// If it exists, decrement its frequency
+	// If the frequency becomes 0, shift the bigger values of the block over it and rebalance the block
+	// If it doesn't exist, return false
+
+    Block* block = findBlock(e);
+    if (block == nullptr)
+        return false;
+    int i = position(block, e);
+    if (i == block->count || block->values[i] != e)
+        return false;
+
+    totalElements--;
+    block->frequencies[i]--;
+    if (block->frequencies[i] > 0)
+        return true;
+    for (int j = i; j < block->count - 1; j++) {
+        block->values[j] = block->values[j + 1];
+        block->frequencies[j] = block->frequencies[j + 1];
+    }
+    block->count--;
+    rebalance(block);
+    return true;
+}
+// Complexity BC=theta(1) WC=theta(n / BLOCK_CAPACITY) Total=theta(n / BLOCK_CAPACITY)
+
+bool UnrolledSortedBag::search(TComp elem) const {
+    return nrOccurrences(elem) > 0;
+}
+// Complexity BC=theta(1) WC=theta(n / BLOCK_CAPACITY) Total=theta(n / BLOCK_CAPACITY)
+
+int UnrolledSortedBag::nrOccurrences(TComp elem) const {
+	// Find the block of the element and the position of the element inside it
+	// If it is there, return its frequency
+	// If it isn't, return 0
+
+    const Block* block = findBlock(elem);
+    if (block == nullptr)
+        return 0;
+    int i = position(block, elem);
+    if (i == block->count || block->values[i] != elem)
+        return 0;
+    return block->frequencies[i];
+}
+// Complexity BC=theta(1) WC=theta(n / BLOCK_CAPACITY) Total=theta(n / BLOCK_CAPACITY)
+
+int UnrolledSortedBag::size() const {
+    return totalElements;
+}
+// Complexity BC=theta(1) WC=theta(1) Total=theta(1)
+
+bool UnrolledSortedBag::isEmpty() const {
+    return totalElements == 0;
+}
+// Complexity BC=theta(1) WC=theta(1) Total=theta(1)
+
+UnrolledSortedBagIterator UnrolledSortedBag::iterator() const {
+    return UnrolledSortedBagIterator(*this);
+}
+// Complexity BC=theta(1) WC=theta(1) Total=theta(1)
+
+void UnrolledSortedBag::empty() {
+    while (head != nullptr) {
+        Block* next = head->next;
+        delete head;
+        head = next;
+    }
+    tail = nullptr;
+    totalElements = 0;
+}
+// Complexity BC=theta(1) WC=theta(n / BLOCK_CAPACITY) Total=theta(n / BLOCK_CAPACITY)
+
+UnrolledSortedBag::~UnrolledSortedBag() {
+    empty();
+}
+// Complexity BC=theta(1) WC=theta(n / BLOCK_CAPACITY) Total=theta(n / BLOCK_CAPACITY)
@@ -0,0 +1,81 @@
+#pragma once
+#include "SortedBag.h"
+
+class UnrolledSortedBagIterator;
+
+// number of (value, frequency) pairs of a block, a block with its links fills two cache lines
+#define BLOCK_CAPACITY 13
+
+// Sorted bag stored as an unrolled doubly linked list: every block holds a small sorted run of distinct values
+// with their frequencies, so searches and traversals scan arrays inside a block and only follow a link per block.
+// Full blocks are split in two, blocks less than half full are merged with a neighbour when both fit in one block.
+class UnrolledSortedBag {
+	friend class UnrolledSortedBagIterator;
+
+private:
+	struct Block {
+		Block* next;
+		Block* prev;
+		int count; // number of distinct values in the block
+		TComp values[BLOCK_CAPACITY]; // values[0..count) are distinct and sorted by rel
+		int frequencies[BLOCK_CAPACITY]; // frequencies[i] = occurrences of values[i], always > 0
+	};
+
+	Block* head;
+	Block* tail;
+	Relation rel;
+	int totalElements;
+
+	// checks whether a comes strictly before b in the order given by rel
+	bool before(TComp a, TComp b) const;
+
+	// returns the block where e is or should be inserted: the first block whose last value does not come before e,
+	// or the last block if there is none; nullptr if the bag is empty
+	Block* findBlock(TComp e) const;
+
+	// position of the first value of the block that does not come before e, count if there is none
+	int position(const Block* block, TComp e) const;
+
+	// moves the upper half of a full block to a new block linked after it
+	void split(Block* block);
+
+	// merges block with a neighbour if it is less than half full and both fit in one block, frees it if it is empty
+	void rebalance(Block* block);
+
+	// moves all the values of second to the end of first and frees second, which must come right after first
+	void join(Block* first, Block* second);
+
+public:
+	//constructor
+	UnrolledSortedBag(Relation r);
+
+	UnrolledSortedBag(const UnrolledSortedBag&) = delete;
+	UnrolledSortedBag& operator=(const UnrolledSortedBag&) = delete;
+
+	//adds an element to the sorted bag
+	void add(TComp e);
+
+	//removes one occurence of an element from a sorted bag
+	//returns true if an eleent was removed, false otherwise (if e was not part of the sorted bag)
+	bool remove(TComp e);
+
+	//checks if an element appearch is the sorted bag
+	bool search(TComp e) const;
+
+	//returns the number of occurrences for an element in the sorted bag
+	int nrOccurrences(TComp e) const;
+
+	//returns the number of elements from the sorted bag
+	int size() const;
+
+	//returns an iterator for this sorted bag
+	UnrolledSortedBagIterator iterator() const;
+
+	//checks if the sorted bag is empty
+	bool isEmpty() const;
+
+	void empty();
+
+	//destructor
+	~UnrolledSortedBag();
+};
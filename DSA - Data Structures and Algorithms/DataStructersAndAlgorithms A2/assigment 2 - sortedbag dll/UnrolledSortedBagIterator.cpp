@@ -0,0 +1,54 @@
+#include "UnrolledSortedBagIterator.h"
+#include <exception>
+
+using namespace std;
+
+UnrolledSortedBagIterator::UnrolledSortedBagIterator(const UnrolledSortedBag& b) : bag(b) {
+	// constructor
+	first();
+}
+//Complexity BC=theta(1) WC=theta(1) Total=theta(1)
+
+TComp UnrolledSortedBagIterator::getCurrent() {
+	//returns the current element from the iterator
+	if (!valid())
+		throw exception();
+	return currentBlock->values[index];
+}
+//Complexity BC=theta(1) WC=theta(1) Total=theta(1)
+
+bool UnrolledSortedBagIterator::valid() {
+	return currentBlock != nullptr;
+}
+//Complexity BC=theta(1) WC=theta(1) Total=theta(1)
+
+void UnrolledSortedBagIterator::next() {
+	//moves the iterator to the next element in the sorted bag
+	//the next value is in the same block unless the current one is the last of its block
+	//throws an exception if the iterator is not valid
+
+	if (!valid())
+		throw exception();
+
+	if (frequencyIndex < currentBlock->frequencies[index]) {
+		frequencyIndex++;
+		return;
+	}
+	frequencyIndex = 1;
+	index++;
+	if (index == currentBlock->count) {
+		currentBlock = currentBlock->next;
+		index = 0;
+	}
+}
+//Complexity BC=theta(1) WC=theta(1) Total=theta(1)
+
+void UnrolledSortedBagIterator::first() {
+	//moves the iterator to the first element of the sorted bag
+	//if the sorted bag is empty, the iterator is invalid
+
+	currentBlock = bag.head;
+	index = 0;
+	frequencyIndex = 1;
+}
+//Complexity BC=theta(1) WC=theta(1) Total=theta(1)
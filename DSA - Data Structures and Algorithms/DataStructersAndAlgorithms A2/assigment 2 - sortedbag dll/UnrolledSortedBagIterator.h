@@ -0,0 +1,21 @@
+#pragma once
+#include "UnrolledSortedBag.h"
+
+class UnrolledSortedBagIterator
+{
+	friend class UnrolledSortedBag;
+
+private:
+	const UnrolledSortedBag& bag;
+	UnrolledSortedBagIterator(const UnrolledSortedBag& b);
+
+	UnrolledSortedBag::Block* currentBlock;
+	int index; // position of the current value inside currentBlock
+	int frequencyIndex;
+
+public:
+	TComp getCurrent();
+	bool valid();
+	void next();
+	void first();
+};